@@ -0,0 +1,141 @@
+/*
+ * atom_pool.c
+ *
+ * Tasks are submitted by one thread into an array sized at start, and
+ * workers claim them in order with a fetch-and-add, so a busy pool
+ * takes no locks. An idle worker sleeps on a condition variable, which
+ * the submitter signals only if some worker is waiting.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "atom_pool.h"
+
+typedef struct {
+    void *(*fn)(void *);
+    int id;
+} atom_task_t;
+
+static atom_task_t *tasks;
+static long capacity;
+static atomic_long num_submitted;
+static atomic_long next_task; // next task for a worker to claim
+static atomic_bool closed; // no more tasks will be submitted
+static atomic_int num_waiting; // workers asleep or about to be
+
+static pthread_t *workers;
+static int num_workers;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t more = PTHREAD_COND_INITIALIZER;
+
+
+/*
+ * Run tasks until the pool is closed and none are left. A worker with
+ * nothing to do announces itself in `num_waiting` before checking once
+ * more, under the lock, so a submission either is seen by the check or
+ * sees the worker and signals it.
+ */
+static void *worker(void *arg) {
+    for (;;) {
+        long i = atomic_load(&next_task);
+
+        if (i < atomic_load(&num_submitted)) {
+            if (atomic_compare_exchange_weak(&next_task, &i, i + 1)) {
+                tasks[i].fn(&tasks[i].id);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&lock);
+        atomic_fetch_add(&num_waiting, 1);
+        if (atomic_load(&next_task) >= atomic_load(&num_submitted)) {
+            if (atomic_load(&closed)) {
+                atomic_fetch_sub(&num_waiting, 1);
+                pthread_mutex_unlock(&lock);
+                return NULL;
+            }
+            pthread_cond_wait(&more, &lock);
+        }
+        atomic_fetch_sub(&num_waiting, 1);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+
+/*
+ * One worker per online processor.
+ */
+int atom_pool_default_workers() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cores < 1 ? 1 : (int)cores;
+}
+
+
+/*
+ * Start `num` workers for at most `max_tasks` tasks.
+ */
+void atom_pool_start(int num, long max_tasks) {
+    tasks = (atom_task_t*)malloc((max_tasks > 0 ? max_tasks : 1) * sizeof(atom_task_t));
+    workers = (pthread_t*)malloc(num * sizeof(pthread_t));
+    if (tasks == NULL || workers == NULL) {
+        fprintf(stderr, "atom_pool: out of memory\n");
+        exit(1);
+    }
+    capacity = max_tasks;
+    atomic_init(&num_submitted, 0);
+    atomic_init(&next_task, 0);
+    atomic_init(&closed, false);
+    atomic_init(&num_waiting, 0);
+
+    num_workers = num;
+    for (int w = 0; w < num_workers; w++) {
+        if (pthread_create(&workers[w], NULL, worker, NULL) != 0) {
+            fprintf(stderr, "atom_pool: error creating worker thread\n");
+            exit(1);
+        }
+    }
+}
+
+
+/*
+ * Submit `fn(&id)` to run on a worker. Only one thread may submit.
+ */
+void atom_pool_submit(void *(*fn)(void *), int id) {
+    long i = atomic_load_explicit(&num_submitted, memory_order_relaxed);
+
+    if (i == capacity) {
+        fprintf(stderr, "atom_pool: more than %ld tasks submitted\n", capacity);
+        exit(1);
+    }
+    tasks[i].fn = fn;
+    tasks[i].id = id;
+    atomic_store(&num_submitted, i + 1);
+
+    if (atomic_load(&num_waiting) > 0) {
+        pthread_mutex_lock(&lock);
+        pthread_cond_signal(&more);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+
+/*
+ * Close the pool and wait for every task submitted to have run.
+ */
+void atom_pool_finish() {
+    pthread_mutex_lock(&lock);
+    atomic_store(&closed, true);
+    pthread_cond_broadcast(&more);
+    pthread_mutex_unlock(&lock);
+
+    for (int w = 0; w < num_workers; w++) {
+        pthread_join(workers[w], NULL);
+    }
+    free(workers);
+    free(tasks);
+}
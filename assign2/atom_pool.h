@@ -0,0 +1,17 @@
+/*
+ * atom_pool.h
+ *
+ * A fixed pool of worker threads that runs atoms as lightweight tasks,
+ * instead of creating a thread per atom. A task is an atom function
+ * (such as `c_ready()`) and the id it is passed a pointer to, stored in
+ * the pool, so no per-atom allocation is needed either.
+ */
+#ifndef _ATOM_POOL_H_
+#define _ATOM_POOL_H_
+
+void atom_pool_start(int num_workers, long max_tasks);
+void atom_pool_submit(void *(*fn)(void *), int id);
+void atom_pool_finish(void);
+int atom_pool_default_workers(void);
+
+#endif
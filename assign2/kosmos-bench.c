@@ -0,0 +1,248 @@
+/*
+ * kosmos-bench.c
+ *
+ * Benchmark of two ways of running atoms through the lock-free matcher
+ * (matcher.c): a thread per atom, as kosmos-*.c do, and tasks on a
+ * fixed pool of worker threads (atom_pool.c). Atoms are generated as in
+ * kosmos-*.c. Each model runs in a child process of its own, so that
+ * the peak memory reported is its own, and molecules are counted but
+ * not logged.
+ *
+ * usage: kosmos-bench <seed> [<num atoms> [<pool workers> [<recipes>]]]
+ *
+ * The pool has one worker per processor unless a number is given (0
+ * also means one per processor). The recipes are a comma-separated
+ * list of formulas, such as CH3O,H2O,CO2 (by default, CH3O alone). One
+ * line is printed per model:
+ *
+ *   model=<threads|pool> workers=<n> atoms=<n> molecules=<n> <formula>=<n>... complete=<yes|no> seconds=<t> atoms_per_s=<r> maxrss_kb=<n>
+ *
+ * where `seconds` runs from the first atom's creation until every atom
+ * has been processed, and `complete` is whether the atoms left over
+ * are too few for any recipe, as they must be. Threads are only joined
+ * once all have been created, as in kosmos-*.c, so with many atoms the
+ * thread-per-atom model may run out of threads, which is reported
+ * instead.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "matcher.h"
+#include "atom_pool.h"
+
+#define C_THRESHOLD 0.2
+#define H_THRESHOLD 0.8
+#define DEFAULT_NUM_ATOMS 100000
+
+#define MAX_ATOM_NAME_LEN 10
+
+long numAtoms = DEFAULT_NUM_ATOMS;
+char *species;              // ATOM_C, ATOM_H or ATOM_O of each atom, in creation order
+recipe_t recipes[MAX_RECIPES];
+int num_recipes;
+
+
+double now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/* Needed to pass legit copy of an integer argument to a pthread */
+int *dupInt(int i) {
+    int *pi = (int *)malloc(sizeof(int));
+    assert(pi != NULL);
+    *pi = i;
+    return pi;
+}
+
+
+void molecule_made(int num, const recipe_t *recipe, const int *atoms, char *maker) {
+}
+
+
+void atom_ready(int kind, const char *prefix, void *arg) {
+    int id = *((int *)arg);
+    char name[MAX_ATOM_NAME_LEN];
+
+    sprintf(name, "%s%03d", prefix, id);
+    matcher_add(kind, id, name);
+}
+
+
+void *c_ready(void *arg) {
+    atom_ready(ATOM_C, "c", arg);
+    return NULL;
+}
+
+
+void *h_ready(void *arg) {
+    atom_ready(ATOM_H, "h", arg);
+    return NULL;
+}
+
+
+void *o_ready(void *arg) {
+    atom_ready(ATOM_O, "o", arg);
+    return NULL;
+}
+
+
+/*
+ * Choose every atom's species with the thresholds of kosmos-*.c.
+ */
+void generate_atoms(long seed) {
+    species = (char *)malloc(numAtoms);
+    assert(species != NULL);
+    srand(seed);
+    for (long i = 0; i < numAtoms; i++) {
+        double random_value = (double)rand() / (double)RAND_MAX;
+
+        if (random_value <= C_THRESHOLD) {
+            species[i] = ATOM_C;
+        } else if (random_value <= H_THRESHOLD) {
+            species[i] = ATOM_H;
+        } else {
+            species[i] = ATOM_O;
+        }
+    }
+}
+
+
+/*
+ * Thread per atom: create them all, then join them. Returns the number
+ * of threads created, which is less than the number of atoms if the
+ * system ran out of threads.
+ */
+long run_threads() {
+    pthread_t *atom = (pthread_t *)malloc(numAtoms * sizeof(pthread_t));
+    int **args = (int **)malloc(numAtoms * sizeof(int *));
+    int ids[3] = { 0, 0, 0 };
+    void *(*ready[3])(void *) = { c_ready, h_ready, o_ready };
+
+    long created;
+
+    assert(atom != NULL && args != NULL);
+    for (created = 0; created < numAtoms; created++) {
+        args[created] = dupInt(++ids[(int)species[created]]);
+        if (pthread_create(&atom[created], NULL, ready[(int)species[created]], args[created]) != 0) {
+            free(args[created]);
+            break;
+        }
+    }
+    for (long i = 0; i < created; i++) {
+        pthread_join(atom[i], NULL);
+        free(args[i]);
+    }
+    free(args);
+    free(atom);
+    return created;
+}
+
+
+/*
+ * Worker pool: submit every atom as a task, then wait for the pool.
+ */
+void run_pool(int workers) {
+    int ids[3] = { 0, 0, 0 };
+    void *(*ready[3])(void *) = { c_ready, h_ready, o_ready };
+
+    atom_pool_start(workers, numAtoms);
+    for (long i = 0; i < numAtoms; i++) {
+        atom_pool_submit(ready[(int)species[i]], ++ids[(int)species[i]]);
+    }
+    atom_pool_finish();
+}
+
+
+/*
+ * Run one model in a child process and print its line.
+ */
+void bench_model(const char *model, int workers) {
+    pid_t pid = fork();
+    int status;
+
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        struct rusage usage;
+        long created = numAtoms;
+        double start, seconds;
+
+        matcher_init(numAtoms, recipes, num_recipes, molecule_made);
+        start = now();
+        if (workers == 0) {
+            created = run_threads();
+        } else {
+            run_pool(workers);
+        }
+        seconds = now() - start;
+        getrusage(RUSAGE_SELF, &usage);
+        if (created < numAtoms) {
+            printf("model=%s workers=%d atoms=%ld failed: no thread could be created for atom %ld maxrss_kb=%ld\n",
+                model, workers, numAtoms, created, usage.ru_maxrss);
+            exit(0);
+        }
+
+        printf("model=%s workers=%d atoms=%ld molecules=%d", model, workers, numAtoms, matcher_molecules(-1));
+        for (int r = 0; r < num_recipes; r++) {
+            printf(" %s=%d", recipes[r].formula, matcher_molecules(r));
+        }
+        printf(" complete=%s seconds=%.3f atoms_per_s=%.0f maxrss_kb=%ld\n",
+            matcher_can_form() ? "no" : "yes", seconds,
+            numAtoms / (seconds > 0 ? seconds : 1e-9), usage.ru_maxrss);
+        matcher_free();
+        exit(0);
+    }
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "The %s model failed\n", model);
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    int workers = atom_pool_default_workers();
+    char methoxy[] = METHOXY;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <seed> [<num atoms> [<pool workers> [<recipes>]]]\n", argv[0]);
+        exit(1);
+    }
+    if (argc >= 3) {
+        numAtoms = atol(argv[2]);
+        if (numAtoms < 1) {
+            fprintf(stderr, "%ld is not a valid number of atoms\n", numAtoms);
+            exit(1);
+        }
+    }
+    if (argc >= 4) {
+        workers = atoi(argv[3]);
+        if (workers < 0) {
+            fprintf(stderr, "%d is not a valid number of workers\n", workers);
+            exit(1);
+        }
+        if (workers == 0) {
+            workers = atom_pool_default_workers();
+        }
+    }
+    num_recipes = matcher_parse_recipes(argc >= 5 ? argv[4] : methoxy, recipes);
+
+    generate_atoms(atol(argv[1]));
+    fflush(stdout);
+    bench_model("threads", 0);
+    bench_model("pool", workers);
+    free(species);
+    return 0;
+}
@@ -0,0 +1,311 @@
+/*
+ * kosmos-lf.c (lock-free)
+ *
+ * For UVic CSC 360, Spring 2024
+ *
+ * Atoms of carbon, hydrogen and oxygen are created at random, and
+ * matched into molecules without taking a lock. usage:
+ *
+ *   kosmos-lf <seed> [<num atoms> [<pool workers> [<recipes>]]]
+ *
+ * Each atom runs either on a thread of its own (the default) or as a
+ * task on a pool of worker threads (atom_pool.c; 0 workers means one
+ * per processor). The recipes are a comma-separated list of formulas,
+ * such as CH3O,H2O,CO2, and by default only methoxy radicals (CH3O)
+ * are made.
+ *
+ * An atom never waits for a partner. It is handed to the matcher
+ * (matcher.c), which puts it in its species' queue and counts it in a
+ * single word of free atoms per species; if the free atoms then make
+ * up a molecule, the atom claims them all with one compare-and-swap
+ * and makes it, and it goes on until no molecule is left to make. An
+ * atom that completes no molecule just returns, to be taken by a later
+ * one. So once every atom has returned, every molecule the atoms allow
+ * has been made, and all main has to do is wait for them (or for the
+ * pool to drain) before dumping the log.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logging.h"
+#include "kosmos.h"
+#include "matcher.h"
+#include "atom_pool.h"
+
+
+/* Random # below threshold that particular atom creation. 
+ * This code is a bit fragile as it depends upon knowledge
+ * of the ordering of the labels.  For now, the labels 
+ * are in alphabetical order, which also matches the values
+ * of the thresholds.
+ */
+
+#define C_THRESHOLD 0.2
+#define H_THRESHOLD 0.8
+#define O_THRESHOLD 1.0
+#define DEFAULT_NUM_ATOMS 40
+
+#define MAX_ATOM_NAME_LEN 10
+
+/* Global / shared variables */
+int  cNum = 0, hNum = 0, oNum = 0;
+long numAtoms;
+int  pool_workers = -1; // Workers in the atom pool, or -1 for a thread per atom
+char *recipe_list = METHOXY; // Molecules to make, e.g. "CH3O,H2O,CO2"
+recipe_t recipes[MAX_RECIPES]; // Parsed from `recipe_list`
+pthread_t *atom_threads = NULL; // With a thread per atom, the atom threads
+
+
+/* Function prototypes */
+void kosmos_init(void);
+void *c_ready(void *);
+void *h_ready(void *);
+void *o_ready(void *);
+void make_radical(int, const recipe_t *, const int *, char *);
+void wait_to_terminate(int);
+
+
+/* Needed to pass legit copy of an integer argument to a pthread */
+int *dupInt( int i )
+{
+	int *pi = (int *)malloc(sizeof(int));
+	assert( pi != NULL);
+	*pi = i;
+	return pi;
+}
+
+
+
+
+int main(int argc, char *argv[])
+{
+	long seed;
+	numAtoms = DEFAULT_NUM_ATOMS;
+	int i;
+	int status;
+    double random_value;
+
+	if ( argc < 2 ) {
+		fprintf(stderr, "usage: %s <seed> [<num atoms> [<pool workers> [<recipes>]]]\n", argv[0]);
+		exit(1);
+	}
+
+	if ( argc >= 2) {
+		seed = atoi(argv[1]);
+	}
+
+	if (argc >= 3) {
+		numAtoms = atoi(argv[2]);
+		if (numAtoms < 0) {
+			fprintf(stderr, "%ld is not a valid number of atoms\n",
+				numAtoms);
+			exit(1);
+		}
+	}
+
+	/* With a third argument, atoms run as tasks on a pool of that
+	 * many worker threads (0: one per processor; -1: a thread each,
+	 * the default) instead of a thread each.
+	 */
+	if (argc >= 4) {
+		pool_workers = atoi(argv[3]);
+		if (pool_workers < -1) {
+			fprintf(stderr, "%d is not a valid number of workers\n",
+				pool_workers);
+			exit(1);
+		}
+		if (pool_workers == 0) {
+			pool_workers = atom_pool_default_workers();
+		}
+	}
+
+	/* A fourth argument lists the molecules to make, e.g.
+	 * CH3O,H2O,CO2; by default only methoxy radicals are made.
+	 */
+	if (argc >= 5) {
+		recipe_list = argv[4];
+	}
+
+    kosmos_log_init();
+	kosmos_init();
+
+	srand(seed);
+	if (pool_workers >= 0) {
+		atom_pool_start(pool_workers, numAtoms);
+	} else {
+		atom_threads = (pthread_t *)malloc(numAtoms * sizeof(pthread_t));
+		assert (atom_threads != NULL);
+	}
+	for (i = 0; i < numAtoms; i++) {
+        random_value = (double)rand() / (double)RAND_MAX;
+
+		if (pool_workers >= 0) {
+			if ( random_value <= C_THRESHOLD ) {
+				atom_pool_submit(c_ready, ++cNum);
+			} else if (random_value <= H_THRESHOLD ) {
+				atom_pool_submit(h_ready, ++hNum);
+			} else {
+				atom_pool_submit(o_ready, ++oNum);
+			}
+			continue;
+		}
+
+		if ( random_value <= C_THRESHOLD ) {
+			cNum++;
+			status = pthread_create (
+					&atom_threads[i], NULL, c_ready,
+					(void *)dupInt(cNum)
+				);
+		} else if (random_value <= H_THRESHOLD ) {
+			hNum++;
+			status = pthread_create (
+					&atom_threads[i], NULL, h_ready,
+					(void *)dupInt(hNum)
+				);
+		} else if (random_value <= O_THRESHOLD) {
+			oNum++;
+			status = pthread_create (
+					&atom_threads[i], NULL, o_ready,
+					(void *)dupInt(oNum)
+				);
+        } else {
+            fprintf(stderr, "SOMETHING HORRIBLY WRONG WITH ATOM GENERATION\n");
+            exit(1);
+        } 
+
+		if (status != 0) {
+			fprintf(stderr, "Error creating atom thread\n");
+			exit(1);
+		}
+	}
+
+    int max_radicals = kosmos_max_radicals(cNum, hNum, oNum);
+#ifdef VERBOSE
+    printf("Maximum # of radicals expected: %d\n", max_radicals);
+#endif
+
+    wait_to_terminate(max_radicals);
+}
+
+
+/*
+ * Prepare the matcher for every recipe in `recipe_list`.
+ */
+void kosmos_init() {
+    char list[MAX_RECIPES * MAX_FORMULA_LEN];
+
+    snprintf(list, sizeof(list), "%s", recipe_list);
+    matcher_init(numAtoms, recipes, matcher_parse_recipes(list, recipes), make_radical);
+}
+
+void *h_ready( void *arg )
+{
+    // Record the id
+	int id = *((int *)arg);
+    if (pool_workers < 0) {
+        free(arg);
+    }
+    char name[MAX_ATOM_NAME_LEN];
+    sprintf(name, "h%03d", id);
+#ifdef VERBOSE
+	printf("%s now exists\n", name);
+#endif
+
+    matcher_add(ATOM_H, id, name);
+	return NULL;
+}
+
+
+void *c_ready( void *arg )
+{
+    // Record the id
+	int id = *((int *)arg);
+    if (pool_workers < 0) {
+        free(arg);
+    }
+    char name[MAX_ATOM_NAME_LEN];
+    sprintf(name, "c%03d", id);
+#ifdef VERBOSE
+	printf("%s now exists\n", name);
+#endif
+
+    matcher_add(ATOM_C, id, name);
+    return NULL;
+}
+
+
+void *o_ready( void *arg )
+{
+    // Record the id
+	int id = *((int *)arg);
+    if (pool_workers < 0) {
+        free(arg);
+    }
+    char name[MAX_ATOM_NAME_LEN];
+    sprintf(name, "o%03d", id);
+#ifdef VERBOSE
+	printf("%s now exists\n", name);
+#endif
+
+    matcher_add(ATOM_O, id, name);
+	return NULL;
+}
+
+
+/*
+ * Log a molecule, called by the matcher on the thread of the atom
+ * `maker` that completed it.
+ */
+void make_radical(int num, const recipe_t *recipe, const int *atoms, char *maker)
+{
+    char line[LOG_MAX_LINE_LEN];
+    int len;
+
+    /* Methoxy radicals are logged as before; atoms are in CH3O order */
+    if (strcmp(recipe->formula, METHOXY) == 0) {
+#ifdef VERBOSE
+        fprintf(stdout, "A methoxy radical was made: c%03d  o%03d  h%03d h%03d h%03d \n",
+            atoms[0], atoms[4], atoms[1], atoms[2], atoms[3]);
+#endif
+        kosmos_log_add_entry(num, atoms[0], atoms[4], atoms[1], atoms[2], atoms[3], maker);
+        return;
+    }
+
+    len = snprintf(line, sizeof(line), "%03d: %s", num, recipe->formula);
+    for (int a = 0; a < recipe->num_atoms && len < (int)sizeof(line); a++) {
+        len += snprintf(line + len, sizeof(line) - len, " %c%03d",
+            species_names[recipe->species[a]] - 'A' + 'a', atoms[a]);
+    }
+    if (len < (int)sizeof(line)) {
+        snprintf(line + len, sizeof(line) - len, " (%s)", maker);
+    }
+#ifdef VERBOSE
+    fprintf(stdout, "A molecule was made: %s\n", line);
+#endif
+    kosmos_log_add_line(line);
+}
+
+
+/*
+ * Every atom has been created by now. Once the last has been matched
+ * every molecule they allow has been made, so the log is complete.
+ * The expected count is only that of methoxy radicals, so it is not
+ * used: waiting for every atom covers any recipes.
+ */
+void wait_to_terminate(int expected_num_radicals) {
+    if (pool_workers >= 0) {
+        atom_pool_finish();
+    } else {
+        for (long i = 0; i < numAtoms; i++) {
+            pthread_join(atom_threads[i], NULL);
+        }
+        free(atom_threads);
+    }
+    kosmos_log_dump();
+    matcher_free();
+    exit(0);
+}
@@ -20,6 +20,7 @@
 #include <string.h>
 #include <unistd.h>
 #include "logging.h"
+#include "kosmos.h"
 
 
 /* Random # below threshold that particular atom creation. 
@@ -49,6 +50,7 @@ void *h_ready(void *);
 void *o_ready(void *);
 void make_radical(int, int, int, int, int, char *);
 void wait_to_terminate(int);
+void kosmos_free(void);
 
 
 /* Needed to pass legit copy of an integer argument to a pthread */
@@ -133,20 +135,21 @@ int main(int argc, char *argv[])
      * straightforward -- it will be the minimum of the number of
      * cNum, oNum, and hNum / 3.
      */
-    int max_radicals = 0;
-
-    if (cNum < oNum && cNum < hNum / 3) {
-        max_radicals = cNum;
-    } else if (oNum < cNum && oNum < hNum / 3) {
-        max_radicals = oNum;
-    } else {
-        max_radicals = (int)(hNum / 3);
-    }
+    int max_radicals = kosmos_max_radicals(cNum, hNum, oNum);
 #ifdef VERBOSE
     printf("Maximum # of radicals expected: %d\n", max_radicals);
 #endif
 
     wait_to_terminate(max_radicals);
+
+	/* No atom waits for a partner, so every thread has returned or will */
+	for (i = 0; i < numAtoms; i++) {
+		pthread_join(*atom[i], NULL);
+		free(atom[i]);
+	}
+	free(atom);
+	kosmos_free();
+	return 0;
 }
 
 /*
@@ -179,7 +182,7 @@ int main(int argc, char *argv[])
  */
 int termination = 0; // boolean used for termination when max radicals are formed
 
-int max_radicals = 0;
+int max_radicals = -1; // known once wait_to_terminate is called
 int radicals = 0; // Counts number of radicals created
 
 int num_free_c = 0; // Keep track of number of created atoms
@@ -188,6 +191,7 @@ int num_free_o = 0;
 
 pthread_mutex_t lock; // mutex to protect shared counters
 pthread_cond_t cond_c, cond_h, cond_o; // conditional variables
+pthread_cond_t done; // signalled for wait_to_terminate
 
 // Keep track of recently created atoms
 int *h_queue = NULL, *o_queue = NULL, *c_queue = NULL; // atom queues
@@ -205,34 +209,32 @@ int radical_ready() {
     return 0;
 }
 
+/*
+ * Wake wait_to_terminate if the last radical has been made. Called
+ * before leaving the critical section.
+ */
+void wake_main() {
+    if (termination) {
+        pthread_cond_signal(&done);
+    }
+}
+
 void kosmos_init() {
-    pthread_mutex_unlock(&lock); // mutex to protect shared variables
+    pthread_mutex_init(&lock, NULL); // mutex to protect shared variables
     pthread_cond_init(&cond_c, NULL);
     pthread_cond_init(&cond_o, NULL);
     pthread_cond_init(&cond_h, NULL);
+    pthread_cond_init(&done, NULL);
     h_queue = (int*)malloc(numAtoms * sizeof(int));
     o_queue = (int*)malloc(numAtoms * sizeof(int));
     c_queue = (int*)malloc(numAtoms * sizeof(int));
-
-    // determine max number of radicals for termination when all have been formed
-    if (cNum < oNum && cNum < hNum / 3) {
-        max_radicals = cNum;
-    } else if (oNum < cNum && oNum < hNum / 3) {
-        max_radicals = oNum;
-    } else {
-        max_radicals = (int)(hNum / 3);
-    }
 }
 
 void *h_ready( void *arg )
 {
-    // Ignore thread if termination is set to true
-    if (termination) {
-        return NULL;
-    }
-    
     // Record the id
 	int id = *((int *)arg);
+    free(arg);
     char name[MAX_ATOM_NAME_LEN];
     sprintf(name, "h%03d", id);
 #ifdef VERBOSE
@@ -242,8 +244,9 @@ void *h_ready( void *arg )
     // Start Critical Section
     pthread_mutex_lock(&lock);
 
-    // Check again for termination, for threads that were blocked when termination began
+    // Nothing more to do once all radicals have been formed
     if (termination) {
+        wake_main();
         pthread_mutex_unlock(&lock);
         return NULL;
     }
@@ -278,6 +281,7 @@ void *h_ready( void *arg )
         }
 
     } 
+    wake_main();
     pthread_mutex_unlock(&lock);
     // End Critical Section
     
@@ -287,13 +291,9 @@ void *h_ready( void *arg )
 
 void *c_ready( void *arg )
 {
-    // Ignore thread if termination is set to true
-    if (termination) {
-        return NULL;
-    }
-    
     // Record the id
 	int id = *((int *)arg);
+    free(arg);
     char name[MAX_ATOM_NAME_LEN];
     sprintf(name, "c%03d", id);
 #ifdef VERBOSE
@@ -303,8 +303,9 @@ void *c_ready( void *arg )
     // Start Critical Section
     pthread_mutex_lock(&lock);
 
-    // Check again for termination, for threads that were blocked when termination began
+    // Nothing more to do once all radicals have been formed
     if (termination) {
+        wake_main();
         pthread_mutex_unlock(&lock);
         return NULL;
     }
@@ -339,6 +340,7 @@ void *c_ready( void *arg )
         }
 
     } 
+    wake_main();
     pthread_mutex_unlock(&lock);
     // End Critical Section
 
@@ -348,13 +350,9 @@ void *c_ready( void *arg )
 
 void *o_ready( void *arg )
 {
-    // Ignore thread if termination is set to true
-    if (termination) {
-        return NULL;
-    }
-    
     // Record the id
 	int id = *((int *)arg);
+    free(arg);
     char name[MAX_ATOM_NAME_LEN];
     sprintf(name, "o%03d", id);
 #ifdef VERBOSE
@@ -364,8 +362,9 @@ void *o_ready( void *arg )
     // Critical Section
     pthread_mutex_lock(&lock);
 
-    // Check again for termination, for threads that were blocked when termination began
+    // Nothing more to do once all radicals have been formed
     if (termination) {
+        wake_main();
         pthread_mutex_unlock(&lock);
         return NULL;
     }
@@ -399,6 +398,7 @@ void *o_ready( void *arg )
             termination = 1;
         }
     }
+    wake_main();
     pthread_mutex_unlock(&lock);
     // End Critical Section
         
@@ -422,12 +422,33 @@ void make_radical(int c, int o, int h1, int h2, int h3, char *maker)
 }
 
 
+/*
+ * Every atom has been created by now, so the number of radicals they
+ * allow is known. The log is dumped as soon as the last radical is
+ * made; the remaining atoms then return at once, for main to join.
+ */
 void wait_to_terminate(int expected_num_radicals) {
-    /* A rather lazy way of doing it, for now. */
-    sleep(MAX_KOSMOS_SECONDS);
+    pthread_mutex_lock(&lock);
+    max_radicals = expected_num_radicals;
+    if (radicals == max_radicals) {
+        termination = 1;
+    }
+    while (!termination) {
+        pthread_cond_wait(&done, &lock);
+    }
+    pthread_mutex_unlock(&lock);
     kosmos_log_dump();
+}
+
+
+/*
+ * Free what kosmos_init allocated, once every atom thread has been
+ * joined.
+ */
+void kosmos_free() {
     free(h_queue);
     free(o_queue);
     free(c_queue);
-    exit(0);
+    pthread_cond_destroy(&done);
+    pthread_mutex_destroy(&lock);
 }
@@ -20,6 +20,7 @@
 #include <string.h>
 #include <unistd.h>
 #include "logging.h"
+#include "kosmos.h"
 
 
 /* Random # below threshold that particular atom creation. 
@@ -49,6 +50,7 @@ void *h_ready(void *);
 void *o_ready(void *);
 void make_radical(int, int, int, int, int, char *);
 void wait_to_terminate(int);
+void kosmos_free(void);
 
 
 /* Needed to pass legit copy of an integer argument to a pthread */
@@ -133,20 +135,21 @@ int main(int argc, char *argv[])
      * straightforward -- it will be the minimum of the number of
      * cNum, oNum, and hNum / 3.
      */
-    int max_radicals = 0;
-
-    if (cNum < oNum && cNum < hNum / 3) {
-        max_radicals = cNum;
-    } else if (oNum < cNum && oNum < hNum / 3) {
-        max_radicals = oNum;
-    } else {
-        max_radicals = (int)(hNum / 3);
-    }
+    int max_radicals = kosmos_max_radicals(cNum, hNum, oNum);
 #ifdef VERBOSE
     printf("Maximum # of radicals expected: %d\n", max_radicals);
 #endif
 
     wait_to_terminate(max_radicals);
+
+	/* No atom waits for a partner, so every thread has returned or will */
+	for (i = 0; i < numAtoms; i++) {
+		pthread_join(*atom[i], NULL);
+		free(atom[i]);
+	}
+	free(atom);
+	kosmos_free();
+	return 0;
 }
 
 /*
@@ -178,7 +181,7 @@ int main(int argc, char *argv[])
  * DECLARE / DEFINE NEEDED VARIABLES IMMEDIATELY BELOW.
  */
 int termination = 0; // boolean used to signal when all radicals have been formed
-int max_radicals = 0;
+int max_radicals = -1; // known once wait_to_terminate is called
 int radicals = 0; // Counts number of radicals created
 
 int num_free_c = 0; // Keep track of number of created atoms
@@ -186,6 +189,9 @@ int num_free_h = 0;
 int num_free_o = 0;
 
 sem_t sem1; // Semaphore to protect critical section
+sem_t done; // Wakes wait_to_terminate
+
+int main_waiting = 0; // wait_to_terminate is waiting for the last radical
 
 // Keep track of recently created atoms
 int *h_queue = NULL, *o_queue = NULL, *c_queue = NULL; // atom queues
@@ -203,31 +209,30 @@ int radical_ready() {
     return 0;
 }
 
+/*
+ * Wake wait_to_terminate if it is waiting and the last radical has been
+ * made. Called before leaving the critical section.
+ */
+void wake_main() {
+    if (main_waiting && termination) {
+        main_waiting = 0;
+        sem_post(&done);
+    }
+}
+
 void kosmos_init() {
     sem_init(&sem1, 0, 1); // semaphore to protect shared variables
+    sem_init(&done, 0, 0);
     h_queue = (int*)malloc(numAtoms * sizeof(int));
     o_queue = (int*)malloc(numAtoms * sizeof(int));
     c_queue = (int*)malloc(numAtoms * sizeof(int));
-
-    // determine max number of radicals for termination when all have been formed
-    if (cNum < oNum && cNum < hNum / 3) {
-        max_radicals = cNum;
-    } else if (oNum < cNum && oNum < hNum / 3) {
-        max_radicals = oNum;
-    } else {
-        max_radicals = (int)(hNum / 3);
-    }
 }
 
 void *h_ready( void *arg )
 {
-    // Ignore thread if termination is set to true
-    if (termination == 1) {
-        return NULL;
-    }
-    
     // Record the id
 	int id = *((int *)arg);
+    free(arg);
     char name[MAX_ATOM_NAME_LEN];
     sprintf(name, "h%03d", id);
 #ifdef VERBOSE
@@ -240,8 +245,9 @@ void *h_ready( void *arg )
     h_queue[rear_h++] = id;
     num_free_h++;
         
-    // Check again for termination, for threads that were blocked when termination began
+    // Nothing more to do once all radicals have been formed
     if (termination) {
+        wake_main();
         sem_post(&sem1);
         return NULL;
     }
@@ -274,6 +280,7 @@ void *h_ready( void *arg )
         }
 
     } 
+    wake_main();
     sem_post(&sem1);
     // End Critical Section
     
@@ -283,13 +290,9 @@ void *h_ready( void *arg )
 
 void *c_ready( void *arg )
 {
-    // Ignore thread if termination is set to true
-    if (termination == 1) {
-        return NULL;
-    }
-    
     // Record the id
 	int id = *((int *)arg);
+    free(arg);
     char name[MAX_ATOM_NAME_LEN];
     sprintf(name, "c%03d", id);
 #ifdef VERBOSE
@@ -303,8 +306,9 @@ void *c_ready( void *arg )
     c_queue[rear_c++] = id;
     num_free_c++;
 
-    // Check again for termination, for threads that were blocked when termination began
+    // Nothing more to do once all radicals have been formed
     if (termination) {
+        wake_main();
         sem_post(&sem1);
         return NULL;
     }
@@ -337,6 +341,7 @@ void *c_ready( void *arg )
         }
 
     } 
+    wake_main();
     sem_post(&sem1);
     // End Critical Section
 
@@ -346,13 +351,9 @@ void *c_ready( void *arg )
 
 void *o_ready( void *arg )
 {
-    // Ignore thread if termination is set to true
-    if (termination == 1) {
-        return NULL;
-    }
-    
     // Record the id
 	int id = *((int *)arg);
+    free(arg);
     char name[MAX_ATOM_NAME_LEN];
     sprintf(name, "o%03d", id);
 #ifdef VERBOSE
@@ -367,8 +368,9 @@ void *o_ready( void *arg )
     num_free_o++;
 
       
-    // Check again for termination, for threads that were blocked when termination began
+    // Nothing more to do once all radicals have been formed
     if (termination) {
+        wake_main();
         sem_post(&sem1);
         return NULL;
     }
@@ -401,6 +403,7 @@ void *o_ready( void *arg )
             termination = 1;
         }
     }
+    wake_main();
     sem_post(&sem1);
     // End Critical Section
         
@@ -424,12 +427,38 @@ void make_radical(int c, int o, int h1, int h2, int h3, char *maker)
 }
 
 
+/*
+ * Every atom has been created by now, so the number of radicals they
+ * allow is known. The log is dumped as soon as the last radical is
+ * made; the remaining atoms then return at once, for main to join.
+ */
 void wait_to_terminate(int expected_num_radicals) {
-    /* A rather lazy way of doing it, for now. */
-    sleep(MAX_KOSMOS_SECONDS);
+    int waiting;
+
+    sem_wait(&sem1);
+    max_radicals = expected_num_radicals;
+    if (radicals == max_radicals) {
+        termination = 1;
+    }
+    waiting = !termination;
+    main_waiting = waiting;
+    sem_post(&sem1);
+
+    if (waiting) {
+        sem_wait(&done);
+    }
     kosmos_log_dump();
+}
+
+
+/*
+ * Free what kosmos_init allocated, once every atom thread has been
+ * joined.
+ */
+void kosmos_free() {
     free(h_queue);
     free(o_queue);
     free(c_queue);
-    exit(0);
+    sem_destroy(&done);
+    sem_destroy(&sem1);
 }
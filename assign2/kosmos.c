@@ -0,0 +1,25 @@
+/*
+ * kosmos.c
+ *
+ * Code shared by the kosmos-*.c variants.
+ */
+
+#include "kosmos.h"
+
+
+/*
+ * The number of methoxy radicals (one carbon, three hydrogens and one
+ * oxygen each) that the given atoms allow: the minimum of c, o and
+ * h / 3.
+ */
+int kosmos_max_radicals(int c, int h, int o) {
+    int max = c;
+
+    if (o < max) {
+        max = o;
+    }
+    if (h / 3 < max) {
+        max = h / 3;
+    }
+    return max;
+}
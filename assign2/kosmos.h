@@ -0,0 +1,11 @@
+/*
+ * kosmos.h
+ *
+ * Code shared by the kosmos-*.c variants.
+ */
+#ifndef _KOSMOS_H_
+#define _KOSMOS_H_
+
+int kosmos_max_radicals(int c, int h, int o);
+
+#endif
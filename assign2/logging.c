@@ -8,55 +8,166 @@
  *
  * DO NOT MODIFY THIS SOURCE-CODE FILE WITHOUT EXPRESS WRITTEN
  * PERMISSION FROM A MEMBER OF THE TEACHING TEAM.
+ *
+ * Each thread appends binary records to a buffer of its own, so adding
+ * an entry takes no lock and formats nothing; the only shared write is
+ * the fetch-and-add that numbers it. A buffer is a list of chunks, each
+ * twice the size of the last, so the log has no fixed capacity and
+ * records never move. Lines are only formatted by kosmos_log_dump,
+ * which merges every buffer's records in sequence order.
  */
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "logging.h"
 
-char kosmos_log[LOG_MAX_LINES][LOG_MAX_LINE_LEN];
-unsigned char kosmos_log_numlines;
-
-
-/* No code outside of this .c file should be able to directly
- * access this mutex.
+#define FIRST_CHUNK_RECORDS 8
+#define MAX_CHUNK_RECORDS 4096
+
+typedef struct {
+    unsigned long seq;
+    int molecule_num;
+    int atoms[5];                       // c, o, h, h, h
+    char instigator[LOG_MAX_NAME_LEN];
+    char *line;                         // from kosmos_log_add_line, else NULL
+} log_record_t;
+
+typedef struct log_chunk {
+    struct log_chunk *next;
+    long capacity;
+    log_record_t records[];
+} log_chunk_t;
+
+/* Written only by its thread; read by kosmos_log_dump up to
+ * `num_records`, which is published after the record is written.
  */
-static pthread_mutex_t kosmos_log_mutex;
+typedef struct log_buffer {
+    struct log_buffer *next;            // next in `buffers`
+    log_chunk_t *first, *last;
+    long last_used;                     // records in `last`
+    atomic_long num_records;
+} log_buffer_t;
+
+static _Atomic(log_buffer_t *) buffers; // every thread's buffer, newest first
+static atomic_ulong next_seq;
+static __thread log_buffer_t *thread_buffer;
 
 
 void kosmos_log_init() {
-    int row;
+    atomic_init(&buffers, NULL);
+    atomic_init(&next_seq, 0);
+}
+
+
+static log_chunk_t *new_chunk(long capacity) {
+    log_chunk_t *chunk = malloc(sizeof(log_chunk_t) + capacity * sizeof(log_record_t));
+
+    if (chunk == NULL) {
+        fprintf(stderr, "logging: out of memory\n");
+        exit(2);
+    }
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    return chunk;
+}
+
 
-    for (row = 0; row < LOG_MAX_LINES; row++) {
-        kosmos_log[row][0] = '\0';
+/*
+ * Return a free record of the calling thread's buffer, creating the
+ * buffer on the thread's first entry. The record is only visible to
+ * kosmos_log_dump once passed to publish_record.
+ */
+static log_record_t *append_record() {
+    log_buffer_t *buffer = thread_buffer;
+
+    if (buffer == NULL) {
+        buffer = malloc(sizeof(log_buffer_t));
+        if (buffer == NULL) {
+            fprintf(stderr, "logging: out of memory\n");
+            exit(2);
+        }
+        buffer->first = buffer->last = new_chunk(FIRST_CHUNK_RECORDS);
+        buffer->last_used = 0;
+        atomic_init(&buffer->num_records, 0);
+        buffer->next = atomic_load(&buffers);
+        while (!atomic_compare_exchange_weak(&buffers, &buffer->next, buffer))
+            ;
+        thread_buffer = buffer;
     }
 
-    kosmos_log_numlines = 0;
+    if (buffer->last_used == buffer->last->capacity) {
+        long capacity = buffer->last->capacity * 2;
 
-    if (pthread_mutex_init(&kosmos_log_mutex, NULL) != 0) {
-        fprintf(stderr, "logging: problems initializing kosmos_log_mutex\n");
-        exit(1);
+        buffer->last->next = new_chunk(capacity < MAX_CHUNK_RECORDS ? capacity : MAX_CHUNK_RECORDS);
+        buffer->last = buffer->last->next;
+        buffer->last_used = 0;
     }
+    return &buffer->last->records[buffer->last_used++];
+}
+
 
+static void publish_record(log_record_t *record, int molecule_num) {
+    record->seq = atomic_fetch_add(&next_seq, 1);
+    record->molecule_num = molecule_num;
+    atomic_fetch_add_explicit(&thread_buffer->num_records, 1, memory_order_release);
+}
+
+
+static int compare_records(const void *a, const void *b) {
+    const log_record_t *x = *(log_record_t * const *)a;
+    const log_record_t *y = *(log_record_t * const *)b;
+
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
 }
 
 
 /*
  * Can be used at any time -- outputs the current contents of the log.
+ * Each buffer is already in sequence order, so sorting merges them.
  */
 void kosmos_log_dump() {
-    pthread_mutex_lock(&kosmos_log_mutex);
+    long total = 0, n = 0;
+    log_record_t **sorted;
+
+    for (log_buffer_t *b = atomic_load(&buffers); b != NULL; b = b->next) {
+        total += atomic_load_explicit(&b->num_records, memory_order_acquire);
+    }
+    sorted = malloc((total > 0 ? total : 1) * sizeof(log_record_t *));
+    if (sorted == NULL) {
+        fprintf(stderr, "logging: out of memory\n");
+        exit(2);
+    }
+
+    // Records published since they were counted are left out
+    for (log_buffer_t *b = atomic_load(&buffers); b != NULL && n < total; b = b->next) {
+        long left = atomic_load_explicit(&b->num_records, memory_order_acquire);
+
+        for (log_chunk_t *chunk = b->first; left > 0 && n < total; chunk = chunk->next) {
+            for (long i = 0; i < chunk->capacity && left > 0 && n < total; i++, left--) {
+                sorted[n++] = &chunk->records[i];
+            }
+        }
+    }
+    qsort(sorted, n, sizeof(log_record_t *), compare_records);
 
-    printf("Lines in log: %d\n", kosmos_log_numlines);
+    printf("Lines in log: %ld\n", n);
 
-    for (int r = 0; r < kosmos_log_numlines; r++) {
-        printf("%s\n", kosmos_log[r]);
-    } 
-    /* Do stuff. */
+    for (long r = 0; r < n; r++) {
+        log_record_t *record = sorted[r];
 
-    pthread_mutex_unlock(&kosmos_log_mutex);
+        if (record->line != NULL) {
+            printf("%s\n", record->line);
+        } else {
+            printf("%03d: c%03d o%03d h%03d h%03d h%03d (%s)\n",
+                record->molecule_num, record->atoms[0], record->atoms[1],
+                record->atoms[2], record->atoms[3], record->atoms[4],
+                record->instigator);
+        }
+    }
+    free(sorted);
 }
 
 
@@ -66,36 +177,31 @@ void kosmos_log_dump() {
 void kosmos_log_add_entry(int molecule_num, int c_one, int o_one, int h_one,
     int h_two, int h_three, char *instigator)
 {
-    char line[LOG_MAX_LINE_LEN];
-
-    if (kosmos_log_numlines == LOG_MAX_LINES) {
-        fprintf(stderr, "logging: The log is full with %d entries already\n",
-            kosmos_log_numlines);
-        exit(2);
-    }
-
-    sprintf(line, "%03d: c%03d o%03d h%03d h%03d h%03d (%s)",
-        molecule_num, c_one, o_one, h_one, h_two, h_three, instigator);
-
-    pthread_mutex_lock(&kosmos_log_mutex);
-    strncpy(kosmos_log[kosmos_log_numlines], line, LOG_MAX_LINE_LEN);
-    kosmos_log_numlines++;
-    pthread_mutex_unlock(&kosmos_log_mutex);
+    log_record_t *record = append_record();
+
+    record->atoms[0] = c_one;
+    record->atoms[1] = o_one;
+    record->atoms[2] = h_one;
+    record->atoms[3] = h_two;
+    record->atoms[4] = h_three;
+    strncpy(record->instigator, instigator, LOG_MAX_NAME_LEN - 1);
+    record->instigator[LOG_MAX_NAME_LEN - 1] = '\0';
+    record->line = NULL;
+    publish_record(record, molecule_num);
 }
 
 
 /*
  * Meant for more general log messages, if that will help during development.
+ * Lines are cut to LOG_MAX_LINE_LEN - 1 characters.
  */
 void kosmos_log_add_line(char *line) {
-    if (kosmos_log_numlines == LOG_MAX_LINES) {
-        fprintf(stderr, "logging: The log is full with %d entries already\n",
-            kosmos_log_numlines);
+    log_record_t *record = append_record();
+
+    record->line = strndup(line, LOG_MAX_LINE_LEN - 1);
+    if (record->line == NULL) {
+        fprintf(stderr, "logging: out of memory\n");
         exit(2);
     }
-
-    pthread_mutex_lock(&kosmos_log_mutex);
-    strncpy(kosmos_log[kosmos_log_numlines], line, LOG_MAX_LINE_LEN);
-    kosmos_log_numlines++;
-    pthread_mutex_unlock(&kosmos_log_mutex);
+    publish_record(record, 0);
 }
@@ -11,8 +11,8 @@
 #ifndef _LOGGING_H_
 #define _LOGGING_H_
 
-#define LOG_MAX_LINES 100
 #define LOG_MAX_LINE_LEN 80
+#define LOG_MAX_NAME_LEN 16
 
 void kosmos_log_init(void);
 void kosmos_log_dump(void);
@@ -0,0 +1,277 @@
+/*
+ * matcher.c
+ *
+ * No locks are taken: each species has its own multi-producer
+ * multi-consumer queue of atom ids, and the free atoms of all the
+ * species are counted in a single 64-bit word, so that one 
+ * compare-and-swap claims all the atoms of a molecule together (e.g.
+ * one carbon, one oxygen and three hydrogens for CH3O). No atom can be
+ * claimed twice, and none is claimed unless the whole molecule is, so
+ * claims never have to be rolled back.
+ *
+ * When the free atoms allow several recipes, the one with the fewest
+ * molecules formed so far is chosen (the first declared on a tie), so
+ * that atoms the recipes compete for are shared out between them.
+ */
+
+#include <assert.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matcher.h"
+
+#define COUNT_BITS 21 // bits of `free_atoms` per species
+#define COUNT_MASK ((UINT64_C(1) << COUNT_BITS) - 1)
+#define ATOM(species) (UINT64_C(1) << ((species) * COUNT_BITS))
+#define CACHE_LINE 64
+
+/*
+ * Bounded MPMC queue after Dmitry Vyukov's
+ * (https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue).
+ * A cell's sequence number is its position while it is free and the
+ * position + 1 once its id has been written. Producers and consumers
+ * each take a position with a fetch-and-add on their own cache line.
+ * The queues hold every atom of the run, so they never fill, and an
+ * atom is counted in `free_atoms` only once it is in its queue, so a
+ * claimed atom is always there to be taken. The cell at the position a
+ * consumer takes may still be being written, though, by a producer that
+ * took that position and has not counted its atom yet; the consumer
+ * then waits for it (see queue_pop).
+ */
+typedef struct {
+    atomic_ulong seq;
+    int id;
+} cell_t;
+
+typedef struct {
+    cell_t *cells;
+    unsigned long mask;
+    _Alignas(CACHE_LINE) atomic_ulong enqueue_pos;
+    _Alignas(CACHE_LINE) atomic_ulong dequeue_pos;
+} atom_queue_t;
+
+const char species_names[NUM_SPECIES] = { 'C', 'H', 'O' };
+
+static atom_queue_t queues[NUM_SPECIES];
+
+static const recipe_t *recipes;
+static int num_recipes;
+static uint64_t recipe_atoms[MAX_RECIPES]; // each recipe's counts, packed as in `free_atoms`
+static atomic_int formed[MAX_RECIPES]; // molecules of each recipe
+
+static _Alignas(CACHE_LINE) _Atomic uint64_t free_atoms; // free atoms of each species, COUNT_BITS each
+static atomic_int molecules; // Counts number of molecules created
+static molecule_fn molecule_made;
+
+
+/*
+ * Parse a comma-separated list of formulas, such as "CH3O,H2O,CO2",
+ * into `recipes` (at least MAX_RECIPES long). Each formula is a
+ * sequence of species symbols (C, H or O), each followed by an
+ * optional count. Returns the number of recipes; exits if the list is
+ * not valid.
+ */
+int matcher_parse_recipes(char *text, recipe_t *recipes) {
+    int count = 0;
+
+    for (char *formula = strtok(text, ","); formula != NULL; formula = strtok(NULL, ",")) {
+        recipe_t *recipe = &recipes[count];
+        const char *p = formula;
+
+        if (count == MAX_RECIPES || strlen(formula) >= MAX_FORMULA_LEN) {
+            fprintf(stderr, "Too many recipes, or recipe \"%s\" too long\n", formula);
+            exit(1);
+        }
+        memset(recipe, 0, sizeof(recipe_t));
+        strcpy(recipe->formula, formula);
+
+        while (*p != '\0') {
+            const char *name = memchr(species_names, *p, NUM_SPECIES);
+            long n;
+
+            if (name == NULL) {
+                fprintf(stderr, "Unknown species '%c' in recipe \"%s\"\n", *p, formula);
+                exit(1);
+            }
+            n = *++p >= '0' && *p <= '9' ? strtol(p, (char **)&p, 10) : 1;
+            if (n < 1 || recipe->num_atoms + n > MAX_RECIPE_ATOMS) {
+                fprintf(stderr, "Recipe \"%s\" must have 1 to %d atoms\n", formula, MAX_RECIPE_ATOMS);
+                exit(1);
+            }
+            recipe->counts[name - species_names] += n;
+            while (n-- > 0) {
+                recipe->species[recipe->num_atoms++] = name - species_names;
+            }
+        }
+        count++;
+    }
+    if (count == 0) {
+        fprintf(stderr, "No recipes given\n");
+        exit(1);
+    }
+    return count;
+}
+
+
+/*
+ * Whether the free atoms are enough for the recipe.
+ */
+static bool recipe_ready(int recipe, uint64_t atoms) {
+    for (int species = 0; species < NUM_SPECIES; species++) {
+        if ((atoms >> (species * COUNT_BITS) & COUNT_MASK) < (uint64_t)recipes[recipe].counts[species]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * The recipe to form from the free atoms, or -1 if there is none: of
+ * those they are enough for, the one with the fewest molecules formed.
+ */
+static int choose_recipe(uint64_t atoms) {
+    int chosen = -1;
+
+    for (int r = 0; r < num_recipes; r++) {
+        if (recipe_ready(r, atoms) && (chosen == -1 ||
+            atomic_load_explicit(&formed[r], memory_order_relaxed) <
+            atomic_load_explicit(&formed[chosen], memory_order_relaxed))) {
+            chosen = r;
+        }
+    }
+    return chosen;
+}
+
+
+static void queue_init(atom_queue_t *queue, long max_atoms) {
+    unsigned long capacity = 1;
+
+    while (capacity < (unsigned long)max_atoms) {
+        capacity *= 2;
+    }
+    queue->cells = (cell_t*)malloc(capacity * sizeof(cell_t));
+    assert(queue->cells != NULL);
+    for (unsigned long i = 0; i < capacity; i++) {
+        atomic_init(&queue->cells[i].seq, i);
+    }
+    queue->mask = capacity - 1;
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+}
+
+
+static void queue_push(atom_queue_t *queue, int id) {
+    unsigned long pos = atomic_fetch_add(&queue->enqueue_pos, 1);
+    cell_t *cell = &queue->cells[pos & queue->mask];
+
+    cell->id = id;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+}
+
+
+static int queue_pop(atom_queue_t *queue) {
+    unsigned long pos = atomic_fetch_add(&queue->dequeue_pos, 1);
+    cell_t *cell = &queue->cells[pos & queue->mask];
+    int id;
+
+    // Wait for a producer that took this position but has not written it
+    while (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1) {
+        sched_yield();
+    }
+    id = cell->id;
+    atomic_store_explicit(&cell->seq, pos + queue->mask + 1, memory_order_release);
+    return id;
+}
+
+
+/*
+ * Prepare for at most `max_atoms` atoms and the recipes, which must
+ * outlive the matcher; `made` is called for each molecule.
+ */
+void matcher_init(long max_atoms, const recipe_t *recipe_list, int count, molecule_fn made) {
+    // Each species' count must fit in COUNT_BITS
+    if (max_atoms > (long)COUNT_MASK) {
+        fprintf(stderr, "At most %ld atoms are supported\n", (long)COUNT_MASK);
+        exit(1);
+    }
+    for (int species = 0; species < NUM_SPECIES; species++) {
+        queue_init(&queues[species], max_atoms);
+    }
+    recipes = recipe_list;
+    num_recipes = count;
+    for (int r = 0; r < num_recipes; r++) {
+        recipe_atoms[r] = 0;
+        for (int species = 0; species < NUM_SPECIES; species++) {
+            recipe_atoms[r] += recipes[r].counts[species] * ATOM(species);
+        }
+        atomic_init(&formed[r], 0);
+    }
+    atomic_init(&free_atoms, 0);
+    atomic_init(&molecules, 0);
+    molecule_made = made;
+}
+
+
+/*
+ * Queue the atom, count it as free, then form molecules as long as
+ * there are atoms enough. Every atom checks after its own arrival, and
+ * goes on checking after each molecule it forms, so no molecule that
+ * the free atoms allow is left unformed.
+ */
+void matcher_add(int species, int id, char *name) {
+    uint64_t atoms;
+    int recipe;
+
+    queue_push(&queues[species], id);
+    atoms = atomic_fetch_add(&free_atoms, ATOM(species)) + ATOM(species);
+
+    while ((recipe = choose_recipe(atoms)) >= 0) {
+        int ids[MAX_RECIPE_ATOMS];
+        int num;
+
+        // Claim the molecule's atoms; on failure `atoms` is reloaded
+        if (!atomic_compare_exchange_weak(&free_atoms, &atoms, atoms - recipe_atoms[recipe])) {
+            continue;
+        }
+        num = atomic_fetch_add(&molecules, 1);
+        atomic_fetch_add(&formed[recipe], 1);
+
+        // Dequeue atoms
+        for (int a = 0; a < recipes[recipe].num_atoms; a++) {
+            ids[a] = queue_pop(&queues[recipes[recipe].species[a]]);
+        }
+
+        molecule_made(num, &recipes[recipe], ids, name);
+
+        atoms = atomic_load(&free_atoms);
+    }
+}
+
+
+/*
+ * Number of molecules of the recipe formed so far, or of all recipes
+ * if `recipe` is -1.
+ */
+int matcher_molecules(int recipe) {
+    return recipe < 0 ? atomic_load(&molecules) : atomic_load(&formed[recipe]);
+}
+
+
+/*
+ * Whether the free atoms are enough for some recipe. Once every atom
+ * has been added, this is false.
+ */
+bool matcher_can_form() {
+    return choose_recipe(atomic_load(&free_atoms)) >= 0;
+}
+
+
+void matcher_free() {
+    for (int species = 0; species < NUM_SPECIES; species++) {
+        free(queues[species].cells);
+    }
+}
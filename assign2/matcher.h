@@ -0,0 +1,57 @@
+/*
+ * matcher.h
+ *
+ * Lock-free matching of atoms into molecules, as used by kosmos-lf and
+ * kosmos-bench. The molecules are given as recipes at startup, such as
+ * CH3O (the methoxy radical), H2O or CO2, and any number may be formed
+ * side by side. Atoms may be added from any number of threads at once,
+ * and no locks are taken. It is not strictly lock-free, though: a
+ * thread forming a molecule may have to wait, yielding the CPU, for
+ * another atom's thread to finish writing its id into a queue, which
+ * takes a few instructions unless that thread is preempted meanwhile.
+ */
+#ifndef _MATCHER_H_
+#define _MATCHER_H_
+
+#include <stdbool.h>
+
+#define ATOM_C 0
+#define ATOM_H 1
+#define ATOM_O 2
+#define NUM_SPECIES 3
+
+#define MAX_RECIPES 8
+#define MAX_RECIPE_ATOMS 12
+#define MAX_FORMULA_LEN 16
+
+#define METHOXY "CH3O"
+
+/*
+ * A molecule: how many atoms of each species it takes, and its atoms'
+ * species in the order of its formula (e.g. C, H, H, H, O for CH3O).
+ */
+typedef struct {
+    char formula[MAX_FORMULA_LEN];
+    int counts[NUM_SPECIES];
+    int num_atoms;
+    int species[MAX_RECIPE_ATOMS];
+} recipe_t;
+
+/*
+ * Called, on the thread of the atom that completed it, for each
+ * molecule formed: its number (taken as its atoms are claimed, over
+ * all recipes), its recipe, the ids of its atoms in the order of
+ * `recipe->species`, and the name of the atom that completed it.
+ */
+typedef void (*molecule_fn)(int, const recipe_t *, const int *, char *);
+
+extern const char species_names[NUM_SPECIES];
+
+int matcher_parse_recipes(char *text, recipe_t *recipes);
+void matcher_init(long max_atoms, const recipe_t *recipes, int num_recipes, molecule_fn made);
+void matcher_add(int species, int id, char *name);
+int matcher_molecules(int recipe);
+bool matcher_can_form(void);
+void matcher_free(void);
+
+#endif
@@ -0,0 +1,324 @@
+/*
+ * casegen.c
+ *
+ * Generate feedbackq test case files from a synthetic workload model.
+ * --------------------
+ * 	Tasks arrive as a Poisson process. Each task is either interactive
+ * 	(many short bursts separated by think times) or CPU-bound (a few
+ * 	long bursts with heavy-tailed, Pareto-distributed lengths and
+ * 	short pauses). A task is created on arrival, its bursts follow,
+ * 	and it exits one tick after its last burst arrives. Task ids are
+ * 	never reused. The same seed always gives the same file.
+ *
+ * 	Burst arrivals are spaced by the think times, not by when the
+ * 	previous burst completes, which depends on the schedule; a burst
+ * 	that arrives before the previous one has finished is added to it
+ * 	by feedbackq.
+ *
+ * Input: Command Line args
+ * ------------------------
+ * 	./casegen [options] > case.txt
+ * 	e.g.
+ * 	     ./casegen --tasks=100000 --seed=7 > big.txt
+ *
+ * 	--tasks=<n>        Number of tasks (default 1000).
+ * 	--seed=<n>         Seed of the random number generator (default 1).
+ * 	--rate=<r>         Mean task arrivals per tick (default 0.01).
+ * 	--interactive=<f>  Fraction of interactive tasks (default 0.8).
+ * 	--short=<t>        Mean interactive burst, exponential (default 3).
+ * 	--think=<t>        Mean interactive think time, exponential
+ * 	                   (default 20).
+ * 	--bursts=<n>       Mean bursts of an interactive task, geometric
+ * 	                   (default 10). CPU-bound tasks have a quarter.
+ * 	--long=<t>         Minimum CPU-bound burst (default 20).
+ * 	--alpha=<a>        Pareto shape of CPU-bound bursts; the smaller,
+ * 	                   the heavier the tail (default 1.5).
+ * 	--max-burst=<t>    Longest burst generated (default 100000).
+ *
+ * Output:
+ * -----------------------
+ * 	Lines `<event_tick>,<task_id>,<burst_time>` in tick order, as
+ * 	described in feedbackq.c, to standard output.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TICK 2000000000			// Leaves room for the exit tick in an int
+
+
+/*
+ * One line of the case file. `seq` keeps the generation order of
+ * events at the same tick.
+ */
+typedef struct Event Event_t;
+struct Event {
+	int			tick;
+	int			task_id;
+	int			burst_time;
+	int			seq;
+};
+
+
+/*
+ * Workload parameters, set from the command line.
+ */
+int num_tasks = 1000;
+uint64_t seed = 1;
+double arrival_rate = 0.01;
+double interactive_fraction = 0.8;
+double mean_short_burst = 3;
+double mean_think_time = 20;
+double mean_bursts = 10;
+double min_long_burst = 20;
+double pareto_alpha = 1.5;
+int max_burst = 100000;
+
+uint64_t rng_state;
+
+Event_t *events;
+int num_events = 0;
+int events_capacity = 0;
+
+
+/*
+ * Function: next_random
+ * ---------------------
+ *  Returns the next 64 random bits, from the xorshift64* generator
+ *  (Vigna, "An experimental exploration of Marsaglia's xorshift
+ *  generators, scrambled", ACM TOMS 42(4), 2016), so that a seed gives
+ *  the same file on every platform.
+ */
+uint64_t next_random() {
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+
+
+/*
+ * Function: uniform
+ * -----------------
+ *  Returns a uniformly distributed double in (0, 1].
+ */
+double uniform() {
+	return ((next_random() >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+
+
+/*
+ * Function: exponential
+ * ---------------------
+ *  Returns an exponentially distributed double with the given mean.
+ */
+double exponential(double mean) {
+	return -log(uniform()) * mean;
+}
+
+
+
+/*
+ * Function: pareto
+ * ----------------
+ *  Returns a Pareto distributed double with minimum `xm` and shape
+ *  `alpha`.
+ */
+double pareto(double xm, double alpha) {
+	return xm / pow(uniform(), 1.0 / alpha);
+}
+
+
+
+/*
+ * Function: to_ticks
+ * ------------------
+ *  Rounds a duration up to whole ticks, between `min` and `max`.
+ */
+int to_ticks(double duration, int min, int max) {
+	double ticks = ceil(duration);
+
+	if(ticks < min) {
+		return min;
+	}
+	if(ticks > max) {
+		return max;
+	}
+	return (int)ticks;
+}
+
+
+
+/*
+ * Function: add_event
+ * -------------------
+ *  Appends an event, growing the array as needed.
+ */
+void add_event(int tick, int task_id, int burst_time) {
+	if(num_events == events_capacity) {
+		events_capacity = events_capacity == 0 ? 4096 : events_capacity * 2;
+		events = realloc(events, events_capacity * sizeof(Event_t));
+		if(events == NULL) {
+			fprintf(stderr, "Out of memory.\n");
+			exit(1);
+		}
+	}
+	events[num_events].tick = tick;
+	events[num_events].task_id = task_id;
+	events[num_events].burst_time = burst_time;
+	events[num_events].seq = num_events;
+	num_events++;
+}
+
+
+
+/*
+ * Function: compare_events
+ * ------------------------
+ *  qsort() comparator ordering events by tick, then generation order.
+ */
+int compare_events(const void *a, const void *b) {
+	const Event_t *x = a;
+	const Event_t *y = b;
+
+	if(x->tick != y->tick) {
+		return x->tick < y->tick ? -1 : 1;
+	}
+	return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+
+
+/*
+ * Function: generate_task
+ * -----------------------
+ *  Adds the events of one task arriving at `tick`: its creation, its
+ *  bursts and its exit, each on a later tick than the one before.
+ *
+ *  task_id: Id of the task
+ *  tick: Arrival tick
+ */
+void generate_task(int task_id, int tick) {
+	int interactive = uniform() <= interactive_fraction;
+	double mean = interactive ? mean_bursts : mean_bursts / 4;
+	int num_bursts = 1;
+
+	// Geometric number of bursts with the given mean (at least one)
+	while(mean > 1 && uniform() > 1.0 / mean) {
+		num_bursts++;
+	}
+
+	add_event(tick, task_id, 0);
+	for(int b = 0; b < num_bursts && tick < MAX_TICK; b++) {
+		int burst, pause;
+
+		if(interactive) {
+			burst = to_ticks(exponential(mean_short_burst), 1, max_burst);
+			pause = to_ticks(exponential(mean_think_time), 1, MAX_TICK);
+		} else {
+			burst = to_ticks(pareto(min_long_burst, pareto_alpha), 1, max_burst);
+			pause = to_ticks(exponential(1), 1, MAX_TICK);
+		}
+		tick = pause > MAX_TICK - tick ? MAX_TICK : tick + pause;
+		add_event(tick, task_id, burst);
+	}
+	add_event(tick + 1, task_id, -1);
+}
+
+
+
+/*
+ * Function: parse_number
+ * ----------------------
+ *  Parses the value of the option `arg` after its `prefix`, which
+ *  must be a number of at least `min`.
+ */
+double parse_number(const char *arg, const char *prefix, double min) {
+	char *end;
+	double value = strtod(arg + strlen(prefix), &end);
+
+	if(end == arg + strlen(prefix) || *end != '\0' || value < min) {
+		fprintf(stderr, "Invalid value in \"%s\"\n", arg);
+		exit(1);
+	}
+	return value;
+}
+
+
+
+/*
+ * Function: validate_args
+ * -----------------------
+ *  Sets the workload parameters from the command line args.
+ */
+void validate_args(int argc, char *argv[]) {
+	static const char *usage = "usage: casegen [--tasks=n] [--seed=n] [--rate=r] "
+		"[--interactive=f] [--short=t] [--think=t] [--bursts=n] [--long=t] "
+		"[--alpha=a] [--max-burst=t]\n";
+
+	for(int i = 1; i < argc; i++) {
+		if(strncmp(argv[i], "--tasks=", 8) == 0) {
+			num_tasks = parse_number(argv[i], "--tasks=", 1);
+		} else if(strncmp(argv[i], "--seed=", 7) == 0) {
+			seed = strtoull(argv[i] + 7, NULL, 10);
+		} else if(strncmp(argv[i], "--rate=", 7) == 0) {
+			arrival_rate = parse_number(argv[i], "--rate=", 1e-9);
+		} else if(strncmp(argv[i], "--interactive=", 14) == 0) {
+			interactive_fraction = parse_number(argv[i], "--interactive=", 0);
+		} else if(strncmp(argv[i], "--short=", 8) == 0) {
+			mean_short_burst = parse_number(argv[i], "--short=", 1);
+		} else if(strncmp(argv[i], "--think=", 8) == 0) {
+			mean_think_time = parse_number(argv[i], "--think=", 1);
+		} else if(strncmp(argv[i], "--bursts=", 9) == 0) {
+			mean_bursts = parse_number(argv[i], "--bursts=", 1);
+		} else if(strncmp(argv[i], "--long=", 7) == 0) {
+			min_long_burst = parse_number(argv[i], "--long=", 1);
+		} else if(strncmp(argv[i], "--alpha=", 8) == 0) {
+			pareto_alpha = parse_number(argv[i], "--alpha=", 0.01);
+		} else if(strncmp(argv[i], "--max-burst=", 12) == 0) {
+			max_burst = parse_number(argv[i], "--max-burst=", 1);
+		} else {
+			fprintf(stderr, "%s", usage);
+			exit(1);
+		}
+	}
+	if(interactive_fraction > 1) {
+		fprintf(stderr, "The interactive fraction must be at most 1\n");
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: main
+ * --------------
+ */
+int main(int argc, char *argv[]) {
+	double arrival = 1;
+
+	validate_args(argc, argv);
+
+	// xorshift must not start from zero; spread the seed's bits
+	rng_state = seed * 0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+	if(rng_state == 0) {
+		rng_state = 1;
+	}
+
+	for(int task_id = 0; task_id < num_tasks && arrival < MAX_TICK; task_id++) {
+		generate_task(task_id, (int)arrival);
+		arrival += exponential(1 / arrival_rate);
+	}
+
+	qsort(events, num_events, sizeof(Event_t), compare_events);
+	for(int i = 0; i < num_events; i++) {
+		printf("%d,%d,%d\n", events[i].tick, events[i].task_id, events[i].burst_time);
+	}
+	free(events);
+	return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef _CASEIO_H_
+#define _CASEIO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CASE_BLOCK_SIZE (1 << 20)
+
+/*
+ * A case file being read line by line. A regular file is mapped into
+ * memory whole; anything else (a pipe, say) is read in blocks of 
+ * CASE_BLOCK_SIZE bytes.
+ */
+typedef struct Case_file Case_file_t;
+struct Case_file {
+    int         fd;
+    char        *data;          // The mapped file, or the block buffer
+    size_t      size;           // Bytes of file contents in `data`
+    size_t      pos;            // Start of the next line
+    size_t      capacity;       // Size of the block buffer
+    bool        mapped;
+    bool        eof;            // Blocks: the rest of the file is in `data`
+};
+
+bool case_open(Case_file_t *, const char *path);
+int case_next_line(Case_file_t *, int *values, int max_values);
+void case_close(Case_file_t *);
+
+#endif
@@ -6,13 +6,74 @@
  * --------------------
  * 	Simulate a Multi-Level Feedback Queue with `3` Levels/Queues each 
  * 	implementing a Round-Robin scheduling policy with a Time Quantum
- * 	of `2`, `4` and `8` resp, and including a boost mechanism.
+ * 	of `2`, `4` and `8` resp, and including a boost mechanism. The
+ * 	number of levels, their quanta and the demotion step may be
+ * 	changed from the command line, and other scheduling policies 
+ * 	(CFS, EEVDF, stride scheduling and SRTF) may be simulated in 
+ * 	place of the MLFQ for comparison.
  * 
  * Input: Command Line args
  * ------------------------
- * 	./feedbackq <input_test_case_file>
+ * 	./feedbackq [options] <input_test_case_file>
  * 	e.g.
  * 	     ./feedbackq test1.txt
+ * 	     ./feedbackq --levels=8 --quanta=1,2,4 test1.txt
+ * 	     ./feedbackq --sweep --quanta=1-4,2-8:2 --boost=10-50:10 test1.txt
+ *
+ * 	--compress     Print runs of identical per-tick lines as a single
+ * 	               line covering a range of ticks, e.g.
+ * 	                   [00002-00003] id=0001 req=17 used=1-2 queue=1
+ * 	                   [00029-00040] IDLE
+ * 	--levels=<n>   Number of queues, 1 to MAX_LEVELS (default 3).
+ * 	--quanta=<q1>,<q2>,...
+ * 	               Time quanta for queue 1, 2, ... Levels not given a
+ * 	               quantum get twice the quantum of the level above
+ * 	               (default 2,4,8).
+ * 	--demote=<n>   Number of levels a task drops when it uses up its
+ * 	               quantum; 0 disables demotion (default 1).
+ * 	--boost=<t>    Ticks between boosts (default BOOST_INTERVAL, 25).
+ * 	--adaptive-boost=<t>
+ * 	               Instead of boosting every queue at fixed intervals,
+ * 	               boost each task that has waited t ticks (mlfq only).
+ * 	               See "Adaptive boosts" below.
+ * 	--cpus=<n>     Simulate n CPUs, 1 to MAX_CPUS (default 1). Each CPU
+ * 	               has its own queues, current task and boosts.
+ * 	--balance=<t>  With several CPUs, rebalance the queues every t
+ * 	               ticks; 0 leaves only idle-time stealing (default 10).
+ * 	--policy=<p>   Scheduling policy: mlfq, cfs, eevdf, stride or srtf
+ * 	               (default mlfq). See "Scheduling policies" below.
+ * 	--slice=<t>    EEVDF request size and stride quantum (default 4).
+ * 	--latency=<t>  CFS scheduling period (default 12).
+ * 	--granularity=<t>
+ * 	               CFS minimum slice and wakeup preemption margin
+ * 	               (default 2).
+ * 	--rt-limit=<p> Percentage of each CPU that real-time tasks may
+ * 	               reserve, 1 to 100 (default 95). See "Real-time 
+ * 	               tasks" below.
+ * 	--stats        After the simulation, print the mean, median, 99th
+ * 	               percentile and maximum of the tasks' waiting times.
+ * 	--trace=<file> Also write a timeline of the simulation to the file,
+ * 	               in Chrome's trace-event JSON format (see trace.h).
+ * 	--histograms   After the simulation, print the distribution of the
+ * 	               response, wait and turnaround times of every burst,
+ * 	               overall and by queue, and of the number of waiting
+ * 	               tasks over time. See "Histograms" below.
+ * 	--output=<m>   What to write to standard output (default text):
+ * 	               text     the lines described under "Output"
+ * 	               binary   a log of fixed-size event records, as
+ * 	                        described in output.h; the CPU report and
+ * 	                        --stats go to standard error
+ * 	               summary  only the EXIT lines, then the number of 
+ * 	                        exits, the mean and maximum waiting and 
+ * 	                        turnaround times, and the last tick
+ * 	--sweep        Instead of printing one simulation, run the MLFQ with
+ * 	               every combination of the quanta and boost intervals
+ * 	               given, and print a table of the mean and 99th
+ * 	               percentile waiting and turnaround times of each. Any
+ * 	               quantum and the boost interval may then be a range
+ * 	               `<lo>-<hi>[:<step>]` (step 1 by default).
+ * 	--threads=<n>  Number of threads a sweep runs its simulations on
+ * 	               (default: the number of online processors).
  * 
  * Input: Test Case file
  * ---------------------
@@ -25,6 +86,18 @@
  * 	2) Special Case:
  * 	     burst_time =  0 -- Task Creation
  * 	     burst_time = -1 -- Task Termination
+ * 	     burst_time = -2 -- I/O Request, on a line of the form
+ *
+ * 	<event_tick>,<task_id>,-2,<device>,<service_time>
+ *
+ * 	     where 0 <= device < MAX_DEVICES. See "Devices" below.
+ * 	     burst_time = -3 -- Periodic Real-Time Task, and
+ * 	     burst_time = -4 -- Sporadic Real-Time Task, on lines of the form
+ *
+ * 	<event_tick>,<task_id>,-3,<runtime>,<period>[,<deadline>]
+ *
+ * 	     where 1 <= runtime <= deadline <= period (deadline defaults to
+ * 	     the period). See "Real-time tasks" below.
  * 
  * 
  * Assumptions: (For Multi-Level Feedback Queue)
@@ -35,20 +108,173 @@
  * 	3) Arrival tick, Burst tick and termination tick for the same  
  * 		Task will never overlap. But the arrival/exit of one  
  * 		Task may overlap with another Task.
- * 	4) Tasks will be labelled from 1 to 10.
+ * 	4) Tasks are labelled with non-negative integers, which need not
+ * 		be contiguous. A label may be reused once its Task has exited.
  * 	5) The event_ticks in the test files will be in sorted order.
  * 	6) Once a Task is assigned a queue, it will always continue to 
  * 		run in that queue for any new future bursts (Unless further 
  * 		demoted, or returned to queue 1 by a boost).
- * 	7) Task termination instruction will always come after the 
- * 		Task completion for the given test case.
+ * 	7) Task termination instruction will normally come after the 
+ * 		Task completion for the given test case. If it arrives while
+ * 		a burst is unfinished, the Task exits (and EXIT is printed)
+ * 		on the tick after the burst completes.
  * 	8) Task arrival/termination/boosting does not consume CPU cycles.
  * 	9) A task is enqueued into one of the queues only if it requires
  * 		CPU bursts.
+ * 	10) A burst arriving for a Task whose previous burst is unfinished
+ * 		(as in generated case files; see casegen.c) extends that
+ * 		burst: the Task keeps its place (unless the policy orders
+ * 		waiting Tasks by remaining burst, as SRTF does), and `req`
+ * 		is the total.
  * 	
  * Output:
  * -----------------------
  * 	NOTE: Do not modify the formatting of the print statements.
+ *
+ * 	With more than one CPU, each per-tick and BOOST line names the
+ * 	CPU (e.g. `[00015] cpu=01 id=0003 req=6 used=2 queue=1`), and a
+ * 	report of each CPU's utilization and migrations follows the
+ * 	simulation.
+ *
+ * Multiple CPUs:
+ * -----------------------
+ * 	A task's bursts are queued on the CPU it last ran on; its first
+ * 	burst goes to the least loaded CPU. A CPU with nothing to run
+ * 	steals the most urgent waiting task of the CPU with the most
+ * 	tasks to spare, and every `--balance` ticks tasks are moved from
+ * 	the most to the least loaded CPU until their loads differ by at
+ * 	most one. A task moved to another CPU counts as a migration.
+ *
+ * Scheduling policies:
+ * -----------------------
+ * 	Each policy is a scheduling class (see sched.h) managing one run
+ * 	queue per CPU, so all of them run on the same case files, CPUs
+ * 	and balancing. Only the MLFQ has levels and boosts; under the 
+ * 	other policies every task reports queue=1 and there is no BOOST.
+ * 	  mlfq    The Multi-Level Feedback Queue described above.
+ * 	  cfs     Linux's Completely Fair Scheduler: least virtual 
+ * 	          runtime first, red-black tree ordered.
+ * 	  eevdf   Earliest Eligible Virtual Deadline First.
+ * 	  stride  Stride scheduling with equal tickets.
+ * 	  srtf    Shortest Remaining Time First.
+ *
+ * Sweeps:
+ * -----------------------
+ * 	The case file is read once into memory and the configurations are
+ * 	handed out to a pool of threads. Every simulation variable (the
+ * 	CPUs, run queues, task table and output) is thread-local, so the
+ * 	simulations share nothing but the instructions, and the table is
+ * 	printed in configuration order once all have finished.
+ *
+ * Devices:
+ * -----------------------
+ * 	A Task blocks on I/O when it issues a request: at once if it has no
+ * 	unfinished CPU burst, otherwise as soon as that burst completes. 
+ * 	Each device serves its requests one at a time, in FIFO order, for
+ * 	their service times, and does so while the CPUs run other Tasks.
+ * 	Bursts arriving for a blocked Task are held back, and enter the 
+ * 	queues (queue 1 for the MLFQ, as for any new burst) when its I/O
+ * 	completes; an EXIT waits for both. A Task has at most one request 
+ * 	outstanding. Completions are handled at the start of a tick,
+ * 	before the instructions.
+ *
+ * 	If any I/O was requested, a report follows the simulation:
+ * 	
+ * 	device=<nn> requests=<n> busy=<t> utilization=<u>%
+ * 	io cpu_only=<t> io_only=<t> overlap=<t> idle=<t>
+ * 	
+ * 	counting the ticks during which only a CPU, only a device, both,
+ * 	or neither were busy.
+ *
+ * Real-time tasks:
+ * -----------------------
+ * 	A created Task becomes a real-time Task with a `-3` (periodic) or 
+ * 	`-4` (sporadic) line, when it has no unfinished burst or I/O. Its
+ * 	CPU time comes in jobs, each of which should complete within 
+ * 	`deadline` ticks of its release: a periodic Task releases a job of
+ * 	`runtime` ticks at once and every `period` ticks after, until its
+ * 	EXIT (or the end of the simulation), while each burst line of a
+ * 	sporadic (or periodic) Task releases a job of that length. A job 
+ * 	released while the previous one is unfinished, or while the Task
+ * 	is blocked on I/O, is dropped and counts as missed. Creating the
+ * 	Task again makes it an ordinary Task, freeing its reserved time.
+ *
+ * 	Real-time Tasks are scheduled Earliest Deadline First (sched_edf.c)
+ * 	ahead of the policy: a CPU only runs the policy's Tasks when it has
+ * 	no real-time Task to run, and a waiting real-time Task preempts any
+ * 	of them. Each runs under a constant bandwidth server (Abeni and 
+ * 	Buttazzo, RTSS 1998), as with Linux's SCHED_DEADLINE, with a budget
+ * 	of `runtime` ticks per `period`. A job released when the server 
+ * 	could not finish its budget by its deadline at the reserved rate 
+ * 	gets a full budget and the deadline `deadline` ticks away; a Task
+ * 	that uses up its budget is throttled until the start of its next
+ * 	period, when the budget is replenished. So a real-time Task never
+ * 	takes more than runtime/period of its CPU, whatever its jobs ask,
+ * 	and the policy's Tasks get the rest.
+ *
+ * 	A real-time Task is admitted to the CPU with the least real-time
+ * 	bandwidth reserved, and stays on it; the case file is rejected if
+ * 	no CPU has runtime/period left under `--rt-limit`. It reports 
+ * 	queue=0, and its time throttled with a job pending counts as 
+ * 	waiting. If there were real-time Tasks, the lines
+ *
+ * 	rt tasks=<n> jobs=<n> met=<n> missed=<n> dropped=<n> miss_rate=<r>% throttles=<n>
+ * 	histogram=response queue=rt ...
+ * 	histogram=lateness queue=rt ...
+ *
+ * 	follow the simulation: the ticks from each job's release to its 
+ * 	completion and, for the jobs that missed their deadline, the ticks
+ * 	by which they did, in the format described under "Histograms". 
+ * 	Real-time jobs are not counted in the other histograms.
+ *
+ * Adaptive boosts:
+ * -----------------------
+ * 	A boost every `--boost` ticks moves every waiting task to queue 1
+ * 	whether or not any of them is starving, preempting the running
+ * 	task to no purpose when none is. With `--adaptive-boost=<t>`, each
+ * 	CPU instead tracks the task that has waited longest below queue 1
+ * 	(the oldest front of its FIFO queues) and, once it has waited t 
+ * 	ticks, moves it to the end of queue 1, printing
+ * 	
+ * 	[<tick>] id=<nnnn> BOOST
+ * 	
+ * 	and so on for the next oldest. Nothing happens while no task is 
+ * 	starving, and the running task is left alone. The case is then
+ * 	simulated again, silently, with boosts every `--boost` ticks, and
+ * 	the lines
+ * 	
+ * 	boost mode=fixed interval=<t> boosts=<n> switches=<n> wt_mean=<t> wt_p99=<t>
+ * 	boost mode=adaptive target=<t> boosts=<n> switches=<n> wt_mean=<t> wt_p99=<t>
+ * 	boost change switches=<p>% wt_p99=<p>%
+ * 	
+ * 	follow the simulation, comparing the number of boosts (of a CPU's
+ * 	queues, or of a task), context switches (picks of a task other 
+ * 	than the one the CPU last ran) and the tasks' waiting times.
+ *
+ * Histograms:
+ * -----------------------
+ * 	For each burst, from its arrival to its completion:
+ * 	  response    ticks until it first runs
+ * 	  wait        ticks spent waiting in a queue
+ * 	  turnaround  ticks until it completes
+ * 	A burst counts towards the queue it completes in (its `queue=`
+ * 	label); a burst extended by another counts once. The lines
+ * 	
+ * 	histogram=<metric> queue=<all|n> count=<n> mean=<t> p50=<t> p90=<t> p99=<t> p99.9=<t> max=<t>
+ * 	
+ * 	follow the simulation, and for `queue_length`, the number of tasks
+ * 	waiting on all CPUs, the count is in ticks. Times are recorded in
+ * 	log-linear buckets (see histogram.h), so percentiles above 128 are
+ * 	accurate to within 1%.
+ *
+ * Simulation:
+ * -----------------------
+ * 	The simulator is event driven. After each scheduling decision it
+ * 	skips straight to the next tick at which something can change
+ * 	(the next instruction, a boost, the end of the
+ * 	current time slice or the end of the current burst), accounting for
+ * 	the ticks in between in one step. The output is identical to that
+ * 	of a tick-by-tick simulation.
  * 
  */
 
@@ -59,6 +285,8 @@
 #include <pthread.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 
 /*
  * A queue structure provided to you by the teaching team. This header
@@ -67,15 +295,109 @@
  * the `makefile`).
  */
 #include "queue.h"
+#include "task_table.h"
+#include "sched.h"
+#include "output.h"
+#include "histogram.h"
+#include "caseio.h"
+#include "trace.h"
 
 
 /* 
  * Some constants related to assignment description.
  */
-#define MAX_INPUT_LINE 100
-#define MAX_TASKS 10
 #define BOOST_INTERVAL 25
-const int QUEUE_TIME_QUANTUMS[] = { 2, 4, 8 };
+#define MAX_QUANTUM (1 << 24)
+#define MAX_CPUS 256
+#define MAX_SWEEP_CONFIGS 100000
+#define MAX_DEVICES 64
+
+/*
+ * Per-burst latencies recorded with --histograms.
+ */
+#define METRIC_RESPONSE 0
+#define METRIC_WAIT 1
+#define METRIC_TURNAROUND 2
+#define NUM_METRICS 3
+
+
+/*
+ * State of one simulated CPU: its run queue and the task it is running.
+ */
+typedef struct Cpu Cpu_t;
+struct Cpu {
+	int			id;
+	void		*rq;					// Run queue of `sched_class`
+	int			num_queued;				// Tasks waiting in the run queue
+	void		*rt_rq;					// Run queue of `sched_edf`
+	int			num_rt_queued;
+	double		rt_bandwidth;			// Sum of runtime/period of its real-time tasks
+	Task_t		*current_task;
+	Task_t		*last_task;				// Last task picked, for counting switches
+
+	long		switches;
+	long		busy_ticks;
+	long		idle_ticks;
+	int			migrations_in;
+	int			migrations_out;
+};
+
+
+/*
+ * State of one simulated I/O device: the request it is serving and the
+ * tasks waiting for it.
+ */
+typedef struct Device Device_t;
+struct Device {
+	Task_t		*current_task;			// Task whose request is in service
+	int			done_at;				// Tick the request completes
+	Queue_t		queue;
+
+	long		busy_ticks;
+	int			requests;
+};
+
+
+/*
+ * Where the simulation takes its instructions from: a case file read 
+ * line by line, or an array of instructions already read.
+ */
+typedef struct Instruction_source Instruction_source_t;
+struct Instruction_source {
+	Case_file_t		*file;
+	Instruction_t	*instructions;
+	int				count;
+	int				next;
+};
+
+
+/*
+ * A range of values `lo`, `lo + step`, ... up to `hi`, swept by --sweep.
+ */
+typedef struct Range Range_t;
+struct Range {
+	int			lo;
+	int			hi;
+	int			step;
+};
+
+
+/*
+ * Results of one simulation: a sweep configuration, or either side of
+ * an --adaptive-boost comparison.
+ */
+typedef struct Sweep_result Sweep_result_t;
+struct Sweep_result {
+	int			time_quantums[MAX_LEVELS];
+	int			boost_interval;
+	int			exits;
+	double		wait_mean;
+	int			wait_p99;
+	double		turnaround_mean;
+	int			turnaround_p99;
+	long		boosts;
+	long		switches;
+};
 
 
 /*
@@ -83,40 +405,378 @@ const int QUEUE_TIME_QUANTUMS[] = { 2, 4, 8 };
  * global, you need not pass them as parameters to functions. 
  * However, you must be careful while initializing/setting these
  * global variables.
+ *
+ * The state of a simulation is thread-local (`__thread`), so each of a
+ * sweep's threads runs its own; the options are shared and read-only
+ * once parsed.
+ */
+__thread Cpu_t cpus[MAX_CPUS];
+int num_cpus = 1;
+int balance_interval = 10;		// Ticks between periodic rebalances (--balance)
+const Sched_class_t *sched_class = &sched_mlfq;
+__thread Sched_config_t sched_config = {
+	.num_levels = 3,
+	.time_quantums = { 2, 4, 8 },
+	.demote_step = 1,
+	.boost_interval = BOOST_INTERVAL,
+	.boost_target = 0,
+	.slice = 4,
+	.latency = 12,
+	.granularity = 2,
+};
+bool compress_output = false;	// Print runs of ticks as ranges (--compress)
+int output_mode = OUTPUT_TEXT;	// --output
+__thread Output_t output;
+char *trace_file = NULL;		// --trace
+__thread Trace_t trace;
+bool print_stats = false;		// Print waiting time statistics (--stats)
+__thread int *wait_times;		// Waiting time of every exited task (--stats, --sweep, --adaptive-boost)
+__thread int *turnaround_times;
+__thread int num_exits = 0;
+__thread int exit_times_capacity = 0;
+bool print_histograms = false;	// --histograms
+__thread Histogram_t burst_histograms[NUM_METRICS][MAX_LEVELS + 1];	// [metric][0] for all queues
+__thread Histogram_t queue_length_histogram;
+__thread Device_t devices[MAX_DEVICES];
+__thread int num_devices = 0;	// One more than the highest device requested
+__thread long cpu_only_ticks, io_only_ticks, overlap_ticks, idle_ticks;
+int rt_limit = 95;				// --rt-limit
+int adaptive_target = 0;		// --adaptive-boost, or 0 for fixed boosts only
+__thread long num_boosts;
+__thread Task_t **rt_tasks;		// Real-time tasks that have not exited
+__thread int num_rt_tasks, rt_tasks_capacity;
+__thread int rt_admitted;		// Real-time tasks ever admitted
+__thread long rt_jobs, rt_met, rt_missed, rt_dropped, rt_throttles;
+__thread Histogram_t rt_response_histogram;
+__thread Histogram_t rt_lateness_histogram;
+
+bool sweep_mode = false;		// --sweep
+int num_threads = 0;			// --threads, or 0 for one per processor
+int num_quanta = 3;				// Levels given a quantum by --quanta
+Range_t quantum_ranges[MAX_LEVELS] = { { 2, 2, 1 }, { 4, 4, 1 }, { 8, 8, 1 } };
+Range_t boost_range = { BOOST_INTERVAL, BOOST_INTERVAL, 1 };
+
+const Sched_class_t *sched_classes[] = {
+	&sched_mlfq, &sched_cfs, &sched_eevdf, &sched_stride, &sched_srtf, NULL
+};
+
+
+/*
+ * Function: parse_range
+ * ---------------------
+ *  Parses `<lo>[-<hi>[:<step>]]` into the range, which must lie within
+ *  [min, max]. Returns false if the text is not such a range.
+ *
+ *  text: Text to parse
+ *  range: Where to store the range
+ *  min, max: Bounds of the values
+ */
+bool parse_range(const char *text, Range_t *range, int min, int max) {
+	char *end;
+
+	range->lo = range->hi = strtol(text, &end, 10);
+	range->step = 1;
+	if(end == text) {
+		return false;
+	}
+	if(*end == '-') {
+		text = end + 1;
+		range->hi = strtol(text, &end, 10);
+		if(end == text) {
+			return false;
+		}
+		if(*end == ':') {
+			text = end + 1;
+			range->step = strtol(text, &end, 10);
+			if(end == text) {
+				return false;
+			}
+		}
+	}
+	return *end == '\0' && range->lo >= min && range->hi <= max &&
+		range->lo <= range->hi && range->step >= 1;
+}
+
+
+
+/*
+ * Function: range_size
+ * --------------------
+ *  Returns the number of values in the range.
+ */
+int range_size(Range_t *range) {
+	return (range->hi - range->lo) / range->step + 1;
+}
+
+
+
+/*
+ * Function: set_quanta
+ * --------------------
+ *  Sets the quanta of the levels given a quantum to the given values,
+ *  and the quanta of the other levels to twice the one above.
+ *
+ *  config: Configuration to set
+ *  quanta: Quanta of the first `num_quanta` levels
  */
-Queue_t *queue_1;
-Queue_t *queue_2;
-Queue_t *queue_3;
-Task_t task_table[MAX_TASKS];
-Task_t *current_task;
-int remaining_quantum = 0;		// Remaining Time Quantum for the current task
+void set_quanta(Sched_config_t *config, int *quanta) {
+	for(int level = 0; level < num_quanta; level++) {
+		config->time_quantums[level] = quanta[level];
+	}
+	for(int level = num_quanta; level < config->num_levels; level++) {
+		config->time_quantums[level] = config->time_quantums[level - 1] * 2;
+		if(config->time_quantums[level] > MAX_QUANTUM) {
+			config->time_quantums[level] = MAX_QUANTUM;
+		}
+	}
+}
+
 
 
 /*
  * Function: validate_args
  * -----------------------
- *  Validate the input command line args.
+ *  Validate the input command line args, setting any options given,
+ *  and return the name of the input test case file.
  *
  *  argc: Number of command line arguments provided
  *  argv: Command line arguments
  */
-void validate_args(int argc, char *argv[]) {
-	if(argc != 2) {
-		fprintf(stderr, "Invalid number of input args provided! Expected 1, received %d\n", argc - 1);
+char *validate_args(int argc, char *argv[]) {
+	char *case_file = NULL;
+	int num_files = 0;
+	int quanta[MAX_LEVELS];
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "--compress") == 0) {
+			compress_output = true;
+		} else if(strncmp(argv[i], "--output=", 9) == 0) {
+			if(strcmp(argv[i] + 9, "text") == 0) {
+				output_mode = OUTPUT_TEXT;
+			} else if(strcmp(argv[i] + 9, "binary") == 0) {
+				output_mode = OUTPUT_BINARY;
+			} else if(strcmp(argv[i] + 9, "summary") == 0) {
+				output_mode = OUTPUT_SUMMARY;
+			} else {
+				fprintf(stderr, "Unknown output mode \"%s\"\n", argv[i] + 9);
+				exit(1);
+			}
+		} else if(strcmp(argv[i], "--stats") == 0) {
+			print_stats = true;
+		} else if(strncmp(argv[i], "--trace=", 8) == 0) {
+			trace_file = argv[i] + 8;
+		} else if(strcmp(argv[i], "--histograms") == 0) {
+			print_histograms = true;
+		} else if(strncmp(argv[i], "--levels=", 9) == 0) {
+			sched_config.num_levels = atoi(argv[i] + 9);
+			if(sched_config.num_levels < 1 || sched_config.num_levels > MAX_LEVELS) {
+				fprintf(stderr, "Number of levels must be between 1 and %d\n", MAX_LEVELS);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--quanta=", 9) == 0) {
+			num_quanta = 0;
+			for(char *q = strtok(argv[i] + 9, ","); q != NULL; q = strtok(NULL, ",")) {
+				if(num_quanta == MAX_LEVELS || !parse_range(q, &quantum_ranges[num_quanta], 1, MAX_QUANTUM)) {
+					fprintf(stderr, "Invalid time quantum \"%s\"\n", q);
+					exit(1);
+				}
+				num_quanta++;
+			}
+			if(num_quanta == 0) {
+				fprintf(stderr, "No time quanta given\n");
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--cpus=", 7) == 0) {
+			num_cpus = atoi(argv[i] + 7);
+			if(num_cpus < 1 || num_cpus > MAX_CPUS) {
+				fprintf(stderr, "Number of CPUs must be between 1 and %d\n", MAX_CPUS);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--balance=", 10) == 0) {
+			balance_interval = atoi(argv[i] + 10);
+			if(balance_interval < 0) {
+				fprintf(stderr, "Balance interval must not be negative\n");
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--demote=", 9) == 0) {
+			sched_config.demote_step = atoi(argv[i] + 9);
+			if(sched_config.demote_step < 0) {
+				fprintf(stderr, "Demotion step must not be negative\n");
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--boost=", 8) == 0) {
+			if(!parse_range(argv[i] + 8, &boost_range, 1, MAX_QUANTUM)) {
+				fprintf(stderr, "Invalid boost interval \"%s\"\n", argv[i] + 8);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--adaptive-boost=", 17) == 0) {
+			adaptive_target = atoi(argv[i] + 17);
+			if(adaptive_target < 1 || adaptive_target > MAX_QUANTUM) {
+				fprintf(stderr, "Adaptive boost target must be between 1 and %d\n", MAX_QUANTUM);
+				exit(1);
+			}
+		} else if(strcmp(argv[i], "--sweep") == 0) {
+			sweep_mode = true;
+		} else if(strncmp(argv[i], "--threads=", 10) == 0) {
+			num_threads = atoi(argv[i] + 10);
+			if(num_threads < 1) {
+				fprintf(stderr, "Number of threads must be positive\n");
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--policy=", 9) == 0) {
+			sched_class = NULL;
+			for(int c = 0; sched_classes[c] != NULL; c++) {
+				if(strcmp(argv[i] + 9, sched_classes[c]->name) == 0) {
+					sched_class = sched_classes[c];
+				}
+			}
+			if(sched_class == NULL) {
+				fprintf(stderr, "Unknown scheduling policy \"%s\"\n", argv[i] + 9);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--slice=", 8) == 0) {
+			sched_config.slice = atoi(argv[i] + 8);
+			if(sched_config.slice < 1 || sched_config.slice > MAX_QUANTUM) {
+				fprintf(stderr, "Slice must be between 1 and %d\n", MAX_QUANTUM);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--latency=", 10) == 0) {
+			sched_config.latency = atoi(argv[i] + 10);
+			if(sched_config.latency < 1 || sched_config.latency > MAX_QUANTUM) {
+				fprintf(stderr, "Latency must be between 1 and %d\n", MAX_QUANTUM);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--granularity=", 14) == 0) {
+			sched_config.granularity = atoi(argv[i] + 14);
+			if(sched_config.granularity < 1 || sched_config.granularity > MAX_QUANTUM) {
+				fprintf(stderr, "Granularity must be between 1 and %d\n", MAX_QUANTUM);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--rt-limit=", 11) == 0) {
+			rt_limit = atoi(argv[i] + 11);
+			if(rt_limit < 1 || rt_limit > 100) {
+				fprintf(stderr, "Real-time limit must be between 1 and 100\n");
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--", 2) == 0) {
+			fprintf(stderr, "Unknown option \"%s\"\n", argv[i]);
+			exit(1);
+		} else {
+			case_file = argv[i];
+			num_files++;
+		}
+	}
+
+	if(num_files != 1) {
+		fprintf(stderr, "Invalid number of input args provided! Expected 1, received %d\n", num_files);
+		exit(1);
+	}
+
+	if(sweep_mode) {
+		long num_configs = range_size(&boost_range);
+		for(int level = 0; level < num_quanta; level++) {
+			num_configs *= range_size(&quantum_ranges[level]);
+			if(num_configs > MAX_SWEEP_CONFIGS) {
+				break;
+			}
+		}
+		if(sched_class != &sched_mlfq) {
+			fprintf(stderr, "Sweeps are only supported for the mlfq policy\n");
+			exit(1);
+		}
+		if(print_histograms || trace_file != NULL || adaptive_target > 0) {
+			fprintf(stderr, "Histograms, traces and adaptive boosts are not supported with --sweep\n");
+			exit(1);
+		}
+		if(num_configs > MAX_SWEEP_CONFIGS) {
+			fprintf(stderr, "A sweep may have at most %d configurations\n", MAX_SWEEP_CONFIGS);
+			exit(1);
+		}
+		return case_file;
+	}
+
+	for(int level = 0; level < num_quanta; level++) {
+		if(range_size(&quantum_ranges[level]) > 1) {
+			fprintf(stderr, "A range of time quanta needs --sweep\n");
+			exit(1);
+		}
+		quanta[level] = quantum_ranges[level].lo;
+	}
+	if(range_size(&boost_range) > 1) {
+		fprintf(stderr, "A range of boost intervals needs --sweep\n");
+		exit(1);
+	}
+	if(adaptive_target > 0 && sched_class->boost_oldest == NULL) {
+		fprintf(stderr, "Adaptive boosts are only supported for the mlfq policy\n");
 		exit(1);
 	}
+	set_quanta(&sched_config, quanta);
+	sched_config.boost_interval = boost_range.lo;
+	sched_config.boost_target = adaptive_target;
+	return case_file;
 }
 
 
 /*
  * Function: initialize_vars
  * -------------------------
- *  Initialize the three queues.
+ *  Initialize the run queue of every CPU, the task table, the
+ *  output and the histograms.
  */
 void initialize_vars() {
-	queue_1 = init_queue();
-	queue_2 = init_queue();
-	queue_3 = init_queue();
+	for(int c = 0; c < num_cpus; c++) {
+		memset(&cpus[c], 0, sizeof(Cpu_t));
+		cpus[c].id = c;
+		cpus[c].rq = sched_class->create(&sched_config);
+		cpus[c].rt_rq = sched_edf.create(&sched_config);
+	}
+	task_table_init();
+	output_init(&output, sweep_mode ? OUTPUT_NONE : output_mode, compress_output, num_cpus > 1);
+	num_exits = 0;
+	num_boosts = 0;
+	for(int m = 0; m < NUM_METRICS; m++) {
+		for(int level = 0; level <= MAX_LEVELS; level++) {
+			histogram_init(&burst_histograms[m][level]);
+		}
+	}
+	histogram_init(&queue_length_histogram);
+	memset(devices, 0, sizeof(devices));
+	num_devices = 0;
+	cpu_only_ticks = io_only_ticks = overlap_ticks = idle_ticks = 0;
+	num_rt_tasks = rt_admitted = 0;
+	rt_jobs = rt_met = rt_missed = rt_dropped = rt_throttles = 0;
+	histogram_init(&rt_response_histogram);
+	histogram_init(&rt_lateness_histogram);
+}
+
+
+
+/*
+ * Function: free_vars
+ * -------------------
+ *  Free what `initialize_vars()` and the simulation allocated.
+ */
+void free_vars() {
+	for(int c = 0; c < num_cpus; c++) {
+		sched_class->destroy(cpus[c].rq);
+		sched_edf.destroy(cpus[c].rt_rq);
+	}
+	task_table_free();
+	free(wait_times);
+	free(turnaround_times);
+	wait_times = turnaround_times = NULL;
+	exit_times_capacity = 0;
+	for(int m = 0; m < NUM_METRICS; m++) {
+		for(int level = 0; level <= MAX_LEVELS; level++) {
+			histogram_free(&burst_histograms[m][level]);
+		}
+	}
+	histogram_free(&queue_length_histogram);
+	free(rt_tasks);
+	rt_tasks = NULL;
+	rt_tasks_capacity = 0;
+	histogram_free(&rt_response_histogram);
+	histogram_free(&rt_lateness_histogram);
 }
 
 /*
@@ -126,399 +786,1837 @@ void initialize_vars() {
  *  appropriate values in the instruction pointer provided. In case
  *  `EOF` is encountered, the `is_eof` flag is set.
  *
- *  fp: File pointer to the input test file
+ *  file: The input test file
  *  instruction: Pointer to store the read instruction details
  */
-void read_instruction(FILE *fp, Instruction_t *instruction) {
-	char line[MAX_INPUT_LINE];
-	
-	if(fgets(line, sizeof(line), fp) == NULL) {
+void read_instruction(Case_file_t *file, Instruction_t *instruction) {
+	int values[6];
+	int vars_read = case_next_line(file, values, 6);
+
+	if(vars_read == EOF) {
 		instruction->event_tick = -1;
 		instruction->is_eof = true;
 		return;
 	}
 
-	int vars_read = sscanf(line, "%d,%d,%d", &instruction->event_tick, 
-	&instruction->task_id, &instruction->burst_time);
 	instruction->is_eof = false;
 
-	if(vars_read == EOF || vars_read != 3) {
-		fprintf(stderr, "Error reading from the file.\n");
-		exit(1);
+	if(vars_read < 3 || (values[2] == -2 && vars_read < 5) ||
+		((values[2] == -3 || values[2] == -4) && vars_read < 5)) {
+		output_error("Error reading from the file.\n");
+	}
+
+	instruction->event_tick = values[0];
+	instruction->task_id = values[1];
+	instruction->burst_time = values[2];
+	instruction->device = vars_read >= 5 ? values[3] : 0;
+	instruction->service_time = vars_read >= 5 ? values[4] : 0;
+	instruction->runtime = vars_read >= 5 ? values[3] : 0;
+	instruction->period = vars_read >= 5 ? values[4] : 0;
+	instruction->deadline = vars_read == 6 ? values[5] : instruction->period;
+
+	if(instruction->burst_time == -2 && (instruction->device < 0 || 
+		instruction->device >= MAX_DEVICES || instruction->service_time < 1)) {
+		output_error("Incorrect file input.\n");
+	}
+
+	if((instruction->burst_time == -3 || instruction->burst_time == -4) &&
+		(instruction->runtime < 1 || instruction->runtime > instruction->deadline ||
+		instruction->deadline > instruction->period)) {
+		output_error("Incorrect file input.\n");
 	}
 
 	if(instruction->event_tick < 0 || instruction->task_id < 0) {
-		fprintf(stderr, "Incorrect file input.\n");
-		exit(1);
+		output_error("Incorrect file input.\n");
 	}
 }
 
 
 
-
 /*
- * Function: get_queue_by_id
- * -------------------------
- *  Returns the Queue associated with the given `queue_id`.
+ * Function: next_instruction
+ * --------------------------
+ *  Gets the next instruction from the source, as `read_instruction()`
+ *  does from a file.
  *
- *  queue_id: Integer Queue identifier.
+ *  source: Case file or array of instructions
+ *  instruction: Pointer to store the instruction details
  */
-Queue_t *get_queue_by_id(int queue_id) {
-	switch (queue_id) {
-		case 1:
-			return queue_1;
-
-		case 2:
-			return queue_2;
-
-		case 3:
-			return queue_3;
+void next_instruction(Instruction_source_t *source, Instruction_t *instruction) {
+	if(source->file != NULL) {
+		read_instruction(source->file, instruction);
+	} else if(source->next < source->count) {
+		*instruction = source->instructions[source->next++];
+	} else {
+		instruction->event_tick = -1;
+		instruction->is_eof = true;
 	}
-	return NULL;
 }
 
 
 
+
 /*
- * Function: handle_instruction
- * ----------------------------
- *  Processes the input instruction, depending on the instruction
- *  type:
- *      a. New Task (burst_time == 0)
- *      b. Task Completion (burst_time == -1)
- *      c. Task Burst (burst_time == <int>)
- *
- *  NOTE: 
- *	a. This method performs NO task scheduling, NO Preemption and NO
- *  	Updation of Task priorities/levels. These tasks would be   
- *		handled by the `scheduler`.
- *	b. A task once demoted to a level, retains that level for all 
- *		future bursts unless it is further demoted or boosted.
- *
- *  instruction: Input instruction
- *  tick: Clock tick (ONLY For Print statements)
+ * Function: is_rt_task
+ * --------------------
+ *  Returns true if the task is a real-time task, scheduled by 
+ *  `sched_edf` rather than the policy.
  */
-void handle_instruction(Instruction_t *instruction, int tick) {
-	int task_id = instruction->task_id;
-    int index = task_id - 1;
+bool is_rt_task(Task_t *task) {
+	return task->rt_runtime > 0;
+}
 
-	
-	if(instruction->burst_time == 0) { 
-		// Initialize New Task 
-        task_table[index].id = task_id;
-        task_table[index].burst_time = 0;
-        task_table[index].remaining_burst_time = 0;
-        task_table[index].current_queue = 0;
-        task_table[index].total_wait_time = 0;
-        task_table[index].total_execution_time = 0;
-        task_table[index].next = NULL;
-
-		printf("[%05d] id=%04d NEW\n", tick, task_id);
-	
-	} else if(instruction->burst_time == -1) { 
-		// Task Termination
-		int waiting_time;
-		int turn_around_time;
-        
-        waiting_time = task_table[index].total_wait_time;
-        turn_around_time = waiting_time + task_table[index].total_execution_time;
 
-		
-		printf("[%05d] id=%04d EXIT wt=%d tat=%d\n", tick, task_id, 
-			waiting_time, turn_around_time);
 
-	} else {
-		// CPU Burst for the task
-        int burst_time = instruction->burst_time;
-		task_table[index].burst_time = burst_time;
-        task_table[index].remaining_burst_time = burst_time;
-        if (task_table[index].current_queue == 0) {
-            task_table[index].current_queue = 1;
-        }
-        
-        // Add the task table and enqueue
-        enqueue(queue_1, &task_table[index]);
-	}
+/*
+ * Function: task_class
+ * --------------------
+ *  Returns the scheduling class of the task.
+ */
+const Sched_class_t *task_class(Task_t *task) {
+	return is_rt_task(task) ? &sched_edf : sched_class;
 }
 
 
 
 /*
- * Function: peek_priority_task
- * ----------------------------
- *  Returns a reference to the Task with the highest priority.
- *  Does NOT dequeue the task.
+ * Function: task_rq
+ * -----------------
+ *  Returns the run queue of the CPU that the task's class uses.
  */
-Task_t *peek_priority_task() {
-	if (!is_empty(queue_1)) {
-        return queue_1->start;
-    }
-    else if (!is_empty(queue_2)) {
-        return queue_2->start;
-    }
-    else if (!is_empty(queue_3)) {
-        return queue_3->start;
-    }
-	return NULL;
+void *task_rq(Cpu_t *cpu, Task_t *task) {
+	return is_rt_task(task) ? cpu->rt_rq : cpu->rq;
 }
 
 
 
 /*
- * Function: decrease_task_level
- * -----------------------------
- *  Updates the task to lower its level(Queue) by 1.
+ * Function: enqueue_task
+ * ----------------------
+ *  Adds the task to the CPU's run queue for its class, recording the
+ *  first tick on which it counts as waiting. Wait time is accumulated 
+ *  lazily by `pick_next_task()` rather than on every tick.
+ *
+ *  cpu: CPU owning the run queue
+ *  task: Task to enqueue
+ *  reason: Why the task is enqueued (ENQUEUE_* in sched.h)
+ *  tick: First tick for which the task is waiting in the queue
  */
-void decrease_task_level(Task_t *task) {
-	task->current_queue = task->current_queue == 3 ? 3 : task->current_queue + 1;
+void enqueue_task(Cpu_t *cpu, Task_t *task, int reason, int tick) {
+	task->enqueued_at = tick;
+	task->cpu = cpu->id;
+	task_class(task)->enqueue(task_rq(cpu, task), task, reason);
+	if(is_rt_task(task)) {
+		cpu->num_rt_queued++;
+	} else {
+		cpu->num_queued++;
+	}
 }
-/*
- * Function: boost
- * -----------------------------
- *  If the current tick is a multiple of the BOOST_INTERVAL, perform a boost
- *  on all tasks in Queue 3, followed by a boost on all tasks in Queue
- *  2.  A boost is done by dequeuing the task from its current queue 
- *  and queuing it into Queue 1.  At the end of this process, all tasks
- *  with remaining CPU bursts should be in Queue 1.  The current task
- *  should be unaffected, except that its remaining quantum should be
- *  set to a maximum of 2 (or left unchanged if it's less than two). 
- *  Boosts do not take CPU time.
- */
 
-void boost(int tick) {
-	
-	if (tick % BOOST_INTERVAL != 0) return;
-    // Boost current task if needed
-    if (current_task != NULL) {
-        Task_t *tempTask = current_task;
-    	if (tempTask->current_queue != 1) {
-            tempTask->current_queue = 1;
-            enqueue(queue_1, tempTask);
-            current_task = NULL;
-        }
-    }
-    
-	if (remaining_quantum > 2) {
-        remaining_quantum = 2;
-    }
-    // Boost queue 3
-    if (!is_empty(queue_3)){
-        Task_t *tempTask = dequeue(queue_3);
-        while (tempTask != NULL) {
-            tempTask->current_queue = 1;
-            enqueue(queue_1, tempTask);
-            tempTask = dequeue(queue_3);
-        }
-    }
-    // Boost queue 2
-    if (!is_empty(queue_2)) {
-        Task_t* tempTask = dequeue(queue_2);
-        while (tempTask != NULL) {
-            tempTask->current_queue = 1;
-            enqueue(queue_1, tempTask);
-            tempTask = dequeue(queue_2);
-        }
-    }
 
-	printf("[%05d] BOOST\n", tick);
-}
 
 /*
- * Function: scheduler
- * -------------------
- *  Schedules the task having the highest priority to be the current 
- *  task. Also, for the currently executing task, decreases the task    
- *	level on completion of the current time quantum.
+ * Function: pick_next_task
+ * ------------------------
+ *  Takes the task to run at `tick` off the CPU's run queues: the
+ *  real-time task EDF chooses if there is one, otherwise the task the
+ *  policy chooses. Adds the ticks it spent waiting to its 
+ *  `total_wait_time` and notes when its burst first runs.
  *
- *  NOTE:
- *  a. The task to be currently executed is `dequeued` from one of the
- *  	queues.
- *  b. On Pre-emption of a task by another task, the preempted task 
- *  	is `enqueued` to the end of its associated queue.
+ *  cpu: CPU owning the run queues
+ *  tick: Clock tick at which the task is picked
  */
-void scheduler() {
+Task_t *pick_next_task(Cpu_t *cpu, int tick) {
+	Task_t *task;
 
-    // Schedule next task if there is not currently a task
-    if (current_task == NULL) {
-        if (!is_empty(queue_1)) {
-            current_task = dequeue(queue_1);
-            remaining_quantum = QUEUE_TIME_QUANTUMS[0];
-        }
-        else if (!is_empty(queue_2)) {
-            current_task = dequeue(queue_2);
-            remaining_quantum = QUEUE_TIME_QUANTUMS[1];
-        }
-        else if (!is_empty(queue_3)) {
-            current_task = dequeue(queue_3);
-            remaining_quantum = QUEUE_TIME_QUANTUMS[2];
-        }
-    } 
-    // schedule higher priority task if there is one
-    else if (current_task != NULL) {
-        int priority = current_task->current_queue;
-        if (priority == 3) {
-            if (!is_empty(queue_1)) {
-                enqueue(queue_3, current_task);
-                current_task = dequeue(queue_1);
-                remaining_quantum = QUEUE_TIME_QUANTUMS[0];
-            }
-            else if (!is_empty(queue_2)) {
-                enqueue(queue_3, current_task);
-                current_task = dequeue(queue_2);
-                remaining_quantum = QUEUE_TIME_QUANTUMS[1];
-            }
-        }
-        else if (priority == 2) {
-            if (!is_empty(queue_1)) {
-                enqueue(queue_2, current_task);
-                current_task = dequeue(queue_1);
-                remaining_quantum = QUEUE_TIME_QUANTUMS[0];
-            }
-        }
-    }
+	if(cpu->num_rt_queued > 0) {
+		task = sched_edf.pick_next(cpu->rt_rq);
+		cpu->num_rt_queued--;
+	} else {
+		task = sched_class->pick_next(cpu->rq);
+		if(task != NULL) {
+			cpu->num_queued--;
+		}
+	}
+
+	if(task != NULL) {
+		if(task != cpu->last_task) {
+			cpu->switches++;
+			cpu->last_task = task;
+		}
+		task->total_wait_time += tick - task->enqueued_at;
+		if(task->burst_started_at < 0) {
+			task->burst_started_at = tick;
+		}
+	}
+	return task;
 }
 
 
 
 /*
- * Function: execute_task
- * ----------------------
- *  Executes the current task (By updating the associated remaining
- *  times). Sets the current_task to NULL on completion of the
- *	current burst.
+ * Function: cpu_load
+ * ------------------
+ *  Returns the number of tasks the CPU is running or has waiting.
  *
- *  tick: Clock tick (ONLY For Print statements)
+ *  cpu: CPU to examine
  */
-void execute_task(int tick) {
-	if(current_task != NULL) {
-        remaining_quantum--;
-        current_task->total_execution_time++;
-        current_task->remaining_burst_time--;
-        
-        printf("[%05d] id=%04d req=%d used=%d queue=%d\n", tick, 
-			current_task->id, current_task->burst_time, 
-			(current_task->burst_time - current_task->remaining_burst_time), 
-			current_task->current_queue);
-        
-        // decrease priority if needed
-        if (remaining_quantum == 0 && current_task->remaining_burst_time > 0) {
-            decrease_task_level(current_task);
-            enqueue(get_queue_by_id(current_task->current_queue), current_task);
-            current_task = NULL;
-        }
-
-        // task terminated
-        else if (current_task->remaining_burst_time == 0) {
-            current_task = NULL;
-        }
-
-
-	} else {
-		printf("[%05d] IDLE\n", tick);
-	}
+int cpu_load(Cpu_t *cpu) {
+	return cpu->num_queued + cpu->num_rt_queued + (cpu->current_task != NULL ? 1 : 0);
 }
 
 
 
 /*
- * Function: update_task_metrics
+ * Function: spare_tasks
+ * ---------------------
+ *  Returns the number of waiting tasks the CPU could give away: those
+ *  beyond the one it would run next if it has no current task. Only
+ *  the policy's tasks move; real-time tasks stay where admitted.
+ *
+ *  cpu: CPU to examine
+ */
+int spare_tasks(Cpu_t *cpu) {
+	return cpu->num_queued - (cpu->current_task == NULL && cpu->num_rt_queued == 0 &&
+		cpu->num_queued > 0 ? 1 : 0);
+}
+
+
+
+/*
+ * Function: least_loaded_cpu
+ * --------------------------
+ *  Returns the CPU with the smallest load (the lowest-numbered one on
+ *  a tie).
+ */
+Cpu_t *least_loaded_cpu() {
+	Cpu_t *best = &cpus[0];
+
+	for(int c = 1; c < num_cpus; c++) {
+		if(cpu_load(&cpus[c]) < cpu_load(best)) {
+			best = &cpus[c];
+		}
+	}
+	return best;
+}
+
+
+
+/*
+ * Function: migrate_task
+ * ----------------------
+ *  Moves the waiting task the policy selects (for the MLFQ, the front
+ *  of the highest-priority non-empty queue) from `from` to `to`. The
+ *  task keeps waiting, so its wait accounting is not touched. Returns
+ *  false if `from` has nothing it can spare, i.e. no waiting task 
+ *  beyond the one it would run next.
+ *
+ *  from: CPU to take the task from
+ *  to: CPU to give the task to
+ */
+bool migrate_task(Cpu_t *from, Cpu_t *to) {
+	if(spare_tasks(from) == 0) {
+		return false;
+	}
+
+	Task_t *task = sched_class->select_migration(from->rq);
+	sched_class->dequeue(from->rq, task, DEQUEUE_MIGRATE);
+	from->num_queued--;
+	task->cpu = to->id;
+	sched_class->enqueue(to->rq, task, ENQUEUE_MIGRATED);
+	to->num_queued++;
+
+	from->migrations_out++;
+	to->migrations_in++;
+	return true;
+}
+
+
+
+/*
+ * Function: steal_task
+ * --------------------
+ *  Called when a CPU has nothing to run: takes a waiting task from the
+ *  CPU with the most tasks to spare, if there is one.
+ *
+ *  cpu: Idle CPU
+ */
+void steal_task(Cpu_t *cpu) {
+	Cpu_t *victim = NULL;
+
+	for(int c = 0; c < num_cpus; c++) {
+		if(&cpus[c] != cpu && spare_tasks(&cpus[c]) > 0 &&
+			(victim == NULL || spare_tasks(&cpus[c]) > spare_tasks(victim))) {
+			victim = &cpus[c];
+		}
+	}
+	if(victim != NULL) {
+		migrate_task(victim, cpu);
+	}
+}
+
+
+
+/*
+ * Function: balance
+ * -----------------
+ *  Every `balance_interval` ticks, moves waiting tasks from the most
+ *  loaded CPU to the least loaded one until no two loads differ by 
+ *  more than one.
+ *
+ *  tick: Clock tick
+ */
+void balance(int tick) {
+	if(num_cpus == 1 || balance_interval == 0 || tick % balance_interval != 0) {
+		return;
+	}
+
+	for(;;) {
+		Cpu_t *busiest = &cpus[0];
+		Cpu_t *idlest = &cpus[0];
+
+		for(int c = 1; c < num_cpus; c++) {
+			if(cpu_load(&cpus[c]) > cpu_load(busiest)) {
+				busiest = &cpus[c];
+			}
+			if(cpu_load(&cpus[c]) < cpu_load(idlest)) {
+				idlest = &cpus[c];
+			}
+		}
+		if(cpu_load(busiest) - cpu_load(idlest) < 2 || !migrate_task(busiest, idlest)) {
+			return;
+		}
+	}
+}
+
+
+
+/*
+ * Function: admit_rt_task
+ * -----------------------
+ *  Makes the task a real-time task with the parameters of the 
+ *  instruction, on the CPU with the least real-time bandwidth reserved
+ *  that has room for it under --rt-limit.
+ *
+ *  task: Task with no unfinished burst or I/O
+ *  instruction: Its `-3` or `-4` instruction
+ *  tick: Clock tick (ONLY For Error messages)
+ */
+void admit_rt_task(Task_t *task, Instruction_t *instruction, int tick) {
+	double bandwidth = (double)instruction->runtime / instruction->period;
+	Cpu_t *cpu = NULL;
+
+	for(int c = 0; c < num_cpus; c++) {
+		if(cpus[c].rt_bandwidth + bandwidth <= rt_limit / 100.0 + 1e-9 &&
+			(cpu == NULL || cpus[c].rt_bandwidth < cpu->rt_bandwidth)) {
+			cpu = &cpus[c];
+		}
+	}
+	if(cpu == NULL) {
+		output_error("Task %d cannot be admitted at tick %d: no CPU has %d/%d of its time left for real-time tasks.\n",
+			task->id, tick, instruction->runtime, instruction->period);
+	}
+
+	cpu->rt_bandwidth += bandwidth;
+	task->cpu = cpu->id;
+	task->current_queue = 0;
+	task->rt_runtime = instruction->runtime;
+	task->rt_period = instruction->period;
+	task->rt_deadline = instruction->deadline;
+	task->rt_budget = 0;
+	task->rt_server_deadline = 0;		// The first job starts a new period
+	task->rt_throttled_until = -1;
+	task->rt_next_release = -1;
+
+	if(num_rt_tasks == rt_tasks_capacity) {
+		rt_tasks_capacity = rt_tasks_capacity == 0 ? 16 : rt_tasks_capacity * 2;
+		rt_tasks = realloc(rt_tasks, rt_tasks_capacity * sizeof(Task_t *));
+		if(rt_tasks == NULL) {
+			output_error("Out of memory.\n");
+		}
+	}
+	rt_tasks[num_rt_tasks++] = task;
+	rt_admitted++;
+}
+
+
+
+/*
+ * Function: remove_rt_task
+ * ------------------------
+ *  Forgets the real-time task, which is exiting or being created 
+ *  again, and frees the bandwidth it reserved.
+ */
+void remove_rt_task(Task_t *task) {
+	int i = 0;
+
+	while(rt_tasks[i] != task) {
+		i++;
+	}
+	memmove(&rt_tasks[i], &rt_tasks[i + 1], (num_rt_tasks - i - 1) * sizeof(Task_t *));
+	num_rt_tasks--;
+	cpus[task->cpu].rt_bandwidth -= (double)task->rt_runtime / task->rt_period;
+}
+
+
+
+/*
+ * Function: release_rt_job
+ * ------------------------
+ *  Releases a job of the real-time task, which is dropped if the task
+ *  is still busy with the previous one. Otherwise the job is queued,
+ *  unless the server is throttled, after applying the CBS wakeup rule:
+ *  if the budget left cannot be used up by the server's deadline at 
+ *  the reserved rate, the server gets a full budget and a new deadline.
+ *
+ *  task: Real-time task
+ *  length: CPU time of the job
+ *  tick: Clock tick at which the job is released
+ */
+void release_rt_job(Task_t *task, int length, int tick) {
+	rt_jobs++;
+	if(task->remaining_burst_time > 0 || task->io_device >= 0) {
+		rt_dropped++;
+		return;
+	}
+
+	task->burst_time = length;
+	task->remaining_burst_time = length;
+	task->burst_arrived_at = tick;
+	task->burst_started_at = -1;
+	task->burst_wait_base = task->total_wait_time;
+	task->rt_job_release = tick;
+
+	if(task->rt_throttled_until >= 0) {
+		// Waits, and is queued when the budget is replenished
+		task->enqueued_at = tick;
+		return;
+	}
+	if(task->rt_server_deadline <= tick || (long long)task->rt_budget * task->rt_deadline >
+		(long long)(task->rt_server_deadline - tick) * task->rt_runtime) {
+		task->rt_server_deadline = tick + task->rt_deadline;
+		task->rt_budget = task->rt_runtime;
+	}
+	enqueue_task(&cpus[task->cpu], task, ENQUEUE_WAKEUP, tick);
+}
+
+
+
+/*
+ * Function: replenish_rt_task
+ * ---------------------------
+ *  Gives the real-time task's server a full budget and a new deadline,
+ *  and queues the task if it has a job pending. The ticks it was 
+ *  throttled with the job pending count as waiting.
+ *
+ *  task: Real-time task
+ *  tick: Clock tick of the replenishment
+ */
+void replenish_rt_task(Task_t *task, int tick) {
+	task->rt_budget = task->rt_runtime;
+	task->rt_server_deadline = tick + task->rt_deadline;
+	task->rt_throttled_until = -1;
+	if(task->remaining_burst_time > 0) {
+		enqueue_task(&cpus[task->cpu], task, ENQUEUE_WAKEUP, task->enqueued_at);
+	}
+}
+
+
+
+/*
+ * Function: throttle_rt_task
+ * --------------------------
+ *  Called when the real-time task has used up its budget: throttles 
+ *  it until the start of its server's next period, or replenishes the
+ *  budget at once if that has passed.
+ *
+ *  task: Real-time task, not running or queued
+ *  tick: Clock tick at which the budget ran out
+ */
+void throttle_rt_task(Task_t *task, int tick) {
+	int replenish_at = task->rt_server_deadline - task->rt_deadline + task->rt_period;
+
+	task->enqueued_at = tick;
+	if(replenish_at <= tick) {
+		replenish_rt_task(task, tick);
+		return;
+	}
+	task->rt_throttled_until = replenish_at;
+	rt_throttles++;
+}
+
+
+
+/*
+ * Function: complete_rt_job
+ * -------------------------
+ *  Records the response time of the real-time task's job, which has 
+ *  just completed, and whether (and by how much) it missed its 
+ *  deadline.
+ *
+ *  task: Real-time task
+ *  tick: Tick after the last tick of the job
+ */
+void complete_rt_job(Task_t *task, int tick) {
+	int lateness = tick - (task->rt_job_release + task->rt_deadline);
+
+	histogram_record(&rt_response_histogram, tick - task->rt_job_release, 1);
+	if(lateness > 0) {
+		rt_missed++;
+		histogram_record(&rt_lateness_histogram, lateness, 1);
+	} else {
+		rt_met++;
+	}
+}
+
+
+
+/*
+ * Function: update_rt_servers
+ * ---------------------------
+ *  Replenishes the budgets of the real-time tasks throttled until 
+ *  `tick`, then releases the jobs of periodic tasks due at `tick`.
+ *
+ *  tick: Clock tick
+ */
+void update_rt_servers(int tick) {
+	for(int i = 0; i < num_rt_tasks; i++) {
+		if(rt_tasks[i]->rt_throttled_until == tick) {
+			replenish_rt_task(rt_tasks[i], tick);
+		}
+	}
+	for(int i = 0; i < num_rt_tasks; i++) {
+		Task_t *task = rt_tasks[i];
+
+		if(task->rt_next_release == tick && !task->exit_pending) {
+			release_rt_job(task, task->rt_runtime, tick);
+			task->rt_next_release = tick + task->rt_period;
+		}
+	}
+}
+
+
+
+/*
+ * Function: report_exit
+ * ---------------------
+ *  Prints the exit line for the task, with its waiting and turnaround
+ *  times, and removes it from the task table.
+ *
+ *  task: Task that exits (must not be queued or running)
+ *  tick: Clock tick (ONLY For Print statements)
+ */
+void report_exit(Task_t *task, int tick) {
+	int waiting_time;
+	int turn_around_time;
+
+	waiting_time = task->total_wait_time;
+	turn_around_time = waiting_time + task->total_execution_time;
+
+	if(print_stats || sweep_mode || adaptive_target > 0) {
+		if(num_exits == exit_times_capacity) {
+			exit_times_capacity = exit_times_capacity == 0 ? 1024 : exit_times_capacity * 2;
+			wait_times = realloc(wait_times, exit_times_capacity * sizeof(int));
+			turnaround_times = realloc(turnaround_times, exit_times_capacity * sizeof(int));
+			if(wait_times == NULL || turnaround_times == NULL) {
+				output_error("Out of memory.\n");
+			}
+		}
+		wait_times[num_exits] = waiting_time;
+		turnaround_times[num_exits++] = turn_around_time;
+	}
+
+	output_exit(&output, tick, task->id, waiting_time, turn_around_time);
+	if(trace_file != NULL) {
+		trace_exit(&trace, tick, task->id, waiting_time, turn_around_time);
+	}
+
+	if(is_rt_task(task)) {
+		remove_rt_task(task);
+	}
+	// Its slot may be reused by a new task, which is not the same task
+	for(int c = 0; c < num_cpus; c++) {
+		if(cpus[c].last_task == task) {
+			cpus[c].last_task = NULL;
+		}
+	}
+	task_table_release(task);
+}
+
+
+
+/*
+ * Function: record_burst
+ * ----------------------
+ *  With --histograms, records the response, wait and turnaround times
+ *  of the task's burst, which has just completed, under its queue and
+ *  under all queues.
+ *
+ *  task: Task whose burst completed
+ *  tick: Tick after the last tick of the burst
+ */
+void record_burst(Task_t *task, int tick) {
+	long long times[NUM_METRICS];
+
+	if(!print_histograms) {
+		return;
+	}
+
+	times[METRIC_RESPONSE] = task->burst_started_at - task->burst_arrived_at;
+	times[METRIC_WAIT] = task->total_wait_time - task->burst_wait_base;
+	times[METRIC_TURNAROUND] = tick - task->burst_arrived_at;
+	for(int m = 0; m < NUM_METRICS; m++) {
+		histogram_record(&burst_histograms[m][0], times[m], 1);
+		histogram_record(&burst_histograms[m][task->current_queue], times[m], 1);
+	}
+}
+
+
+
+/*
+ * Function: start_burst
+ * ---------------------
+ *  Gives the task, which has no unfinished burst, a new CPU burst and
+ *  enqueues it: on the CPU it last ran on, or on the least loaded CPU 
+ *  for its first burst.
+ *
+ *  task: Task the burst belongs to
+ *  burst_time: Length of the burst
+ *  tick: Clock tick at which the burst arrives
+ */
+void start_burst(Task_t *task, int burst_time, int tick) {
+	Cpu_t *cpu;
+
+	task->burst_time = burst_time;
+	task->remaining_burst_time = burst_time;
+	task->burst_arrived_at = tick;
+	task->burst_started_at = -1;
+	task->burst_wait_base = task->total_wait_time;
+	if(task->current_queue == 0) {
+		task->current_queue = 1;
+		cpu = least_loaded_cpu();
+	} else {
+		cpu = &cpus[task->cpu];
+	}
+
+	enqueue_task(cpu, task, ENQUEUE_WAKEUP, tick);
+}
+
+
+
+/*
+ * Function: serve_io
+ * ------------------
+ *  Starts serving the task's request on the device.
+ *
+ *  device: Idle device
+ *  task: Task whose request is served
+ *  tick: First tick of the service
+ */
+void serve_io(Device_t *device, Task_t *task, int tick) {
+	device->current_task = task;
+	device->done_at = tick + task->io_service_time;
+	device->busy_ticks += task->io_service_time;
+}
+
+
+
+/*
+ * Function: start_io
+ * ------------------
+ *  Issues the task's I/O request: the task blocks, and its request is
+ *  served at once if the device is idle, or joins the device's queue.
+ *
+ *  task: Task with an I/O request and no unfinished burst
+ *  tick: Clock tick at which the request is issued
+ */
+void start_io(Task_t *task, int tick) {
+	Device_t *device = &devices[task->io_device];
+
+	device->requests++;
+	if(device->current_task == NULL) {
+		serve_io(device, task, tick);
+	} else {
+		enqueue(&device->queue, task);
+	}
+}
+
+
+
+/*
+ * Function: complete_io
+ * ---------------------
+ *  Completes the requests whose service ends at `tick`, starting the
+ *  next request of each device. A task whose I/O completes is given 
+ *  the bursts held back meanwhile, or exits if its EXIT has been seen.
+ *
+ *  tick: Clock tick
+ */
+void complete_io(int tick) {
+	for(int d = 0; d < num_devices; d++) {
+		Device_t *device = &devices[d];
+		Task_t *task = device->current_task;
+
+		if(task == NULL || device->done_at != tick) {
+			continue;
+		}
+
+		device->current_task = NULL;
+		if(!is_empty(&device->queue)) {
+			serve_io(device, dequeue(&device->queue), tick);
+		}
+
+		task->io_device = -1;
+		if(task->io_held_burst > 0) {
+			start_burst(task, task->io_held_burst, tick);
+			task->io_held_burst = 0;
+		} else if(task->exit_pending) {
+			report_exit(task, tick);
+		}
+	}
+}
+
+
+
+/*
+ * Function: handle_instruction
+ * ----------------------------
+ *  Processes the input instruction, depending on the instruction
+ *  type:
+ *      a. New Task (burst_time == 0)
+ *      b. Task Completion (burst_time == -1)
+ *      c. Task Burst (burst_time == <int>)
+ *
+ *  NOTE: 
+ *	a. This method performs NO task scheduling, NO Preemption and NO
+ *  	Updation of Task priorities/levels. These tasks would be   
+ *		handled by the `scheduler`.
+ *	b. A task once demoted to a level, retains that level for all 
+ *		future bursts unless it is further demoted or boosted.
+ *	c. A burst is queued on the CPU the task last ran on, or on the
+ *		least loaded CPU for its first burst.
+ *	d. A burst arriving before the task's previous burst completes is
+ *		added to it, and one arriving while it is blocked on I/O is held
+ *		until the I/O completes.
+ *
+ *  instruction: Input instruction
+ *  tick: Clock tick (ONLY For Print statements)
+ */
+void handle_instruction(Instruction_t *instruction, int tick) {
+	int task_id = instruction->task_id;
+	Task_t *task;
+
+	
+	if(instruction->burst_time == 0) { 
+		// Initialize New Task 
+        task = task_table_lookup(task_id);
+        if (task != NULL && (task->remaining_burst_time > 0 || task->io_device >= 0)) {
+            output_error("Task %d created at tick %d while still running.\n", task_id, tick);
+        }
+        if (task != NULL && is_rt_task(task)) {
+            // A new task is not real-time: give back what it reserved
+            remove_rt_task(task);
+        }
+        task = task_table_create(task_id);
+        task->burst_time = 0;
+        task->remaining_burst_time = 0;
+        task->current_queue = 0;
+        task->total_wait_time = 0;
+        task->enqueued_at = 0;
+        task->total_execution_time = 0;
+        task->exit_pending = false;
+        task->io_device = -1;
+        task->io_held_burst = 0;
+        task->rt_runtime = 0;
+        task->rt_throttled_until = -1;
+        task->rt_next_release = -1;
+        task->next = NULL;
+
+		output_new(&output, tick, task_id);
+		if(trace_file != NULL) {
+			trace_new(&trace, tick, task_id);
+		}
+		return;
+	}
+
+	task = task_table_lookup(task_id);
+	if(task == NULL) {
+		output_error("Task %d used at tick %d before being created.\n", task_id, tick);
+	}
+
+	if(instruction->burst_time == -1) { 
+		// Task Termination
+        if (task->remaining_burst_time > 0 || task->io_device >= 0) {
+            // Exit once the unfinished burst and I/O are done
+            task->exit_pending = true;
+        } else {
+            report_exit(task, tick);
+        }
+
+	} else if(instruction->burst_time == -2) {
+		// I/O request
+        if (task->io_device >= 0) {
+            output_error("Task %d requested I/O at tick %d while blocked on I/O.\n", task_id, tick);
+        }
+        task->io_device = instruction->device;
+        task->io_service_time = instruction->service_time;
+        if (instruction->device >= num_devices) {
+            num_devices = instruction->device + 1;
+        }
+        // Otherwise issued when the burst completes (see `execute_task()`)
+        if (task->remaining_burst_time == 0) {
+            start_io(task, tick);
+        }
+
+	} else if(instruction->burst_time == -3 || instruction->burst_time == -4) {
+		// Real-time task, periodic (-3) or sporadic (-4)
+        if (is_rt_task(task) || task->remaining_burst_time > 0 || task->io_device >= 0) {
+            output_error("Task %d made real-time at tick %d while busy or already real-time.\n", task_id, tick);
+        }
+        admit_rt_task(task, instruction, tick);
+        if (instruction->burst_time == -3) {
+            release_rt_job(task, task->rt_runtime, tick);
+            task->rt_next_release = tick + task->rt_period;
+        }
+
+	} else {
+		// CPU Burst for the task
+        int burst_time = instruction->burst_time;
+
+        if (is_rt_task(task)) {
+            release_rt_job(task, burst_time, tick);
+            return;
+        }
+
+        if (task->io_device >= 0) {
+            // Blocked: the burst runs once the I/O completes
+            task->io_held_burst += burst_time;
+            return;
+        }
+
+        if (task->remaining_burst_time > 0) {
+            // Still queued or running: the burst just gets longer, and
+            // a waiting task is requeued if that changes its place
+            Cpu_t *cpu = &cpus[task->cpu];
+            bool requeue = sched_class->burst_ordered && cpu->current_task != task;
+
+            if (requeue) {
+                sched_class->dequeue(cpu->rq, task, DEQUEUE_MIGRATE);
+            }
+            task->burst_time += burst_time;
+            task->remaining_burst_time += burst_time;
+            if (requeue) {
+                sched_class->enqueue(cpu->rq, task, ENQUEUE_MIGRATED);
+            }
+            return;
+        }
+
+        start_burst(task, burst_time, tick);
+	}
+}
+
+
+
+/*
+ * Function: boost
+ * -----------------------------
+ *  If the policy boosts (only the MLFQ does) and the current tick is a
+ *  multiple of its boost interval, perform a boost of the CPU's run
+ *  queue: for the MLFQ, all tasks with remaining CPU bursts are moved 
+ *  to Queue 1 (see `mlfq_boost()`). Boosts do not take CPU time. Each
+ *  CPU boosts its own queues.
+ *
+ *  cpu: CPU to boost
+ *  tick: Clock tick
+ */
+void boost(Cpu_t *cpu, int tick) {
+	if (sched_class->boost == NULL || tick % sched_config.boost_interval != 0) return;
+
+    // The policy may put the current task back on the run queue; a
+    // real-time task is not the policy's to boost
+    Task_t *curr = cpu->current_task;
+    if (curr != NULL && is_rt_task(curr)) {
+        curr = NULL;
+    }
+    if (sched_class->boost(cpu->rq, curr)) {
+        cpu->current_task->enqueued_at = tick;
+        cpu->num_queued++;
+        cpu->current_task = NULL;
+    }
+
+	num_boosts++;
+	output_boost(&output, tick, cpu->id);
+	if(trace_file != NULL) {
+		trace_boost(&trace, tick, cpu->id);
+	}
+}
+
+
+
+/*
+ * Function: adaptive_boost
+ * ------------------------
+ *  With --adaptive-boost, boosts each task that has waited at least 
+ *  `boost_target` ticks below the policy's top level on the CPU, oldest
+ *  first (for the MLFQ, by moving it to the end of Queue 1; see 
+ *  `mlfq_boost_oldest()`). The running task is left alone.
+ *
+ *  cpu: CPU to boost
+ *  tick: Clock tick
+ */
+void adaptive_boost(Cpu_t *cpu, int tick) {
+	while(sched_class->oldest_waiting(cpu->rq) <= tick - sched_config.boost_target) {
+		Task_t *task = sched_class->boost_oldest(cpu->rq);
+
+		num_boosts++;
+		output_boost_task(&output, tick, cpu->id, task->id);
+		if(trace_file != NULL) {
+			trace_boost(&trace, tick, cpu->id);
+		}
+	}
+}
+
+/*
+ * Function: preempt_needed
+ * ------------------------
+ *  Returns true if a waiting task should preempt the CPU's current
+ *  task: any waiting real-time task preempts a task of the policy, and
+ *  otherwise the current task's class decides.
+ *
+ *  cpu: CPU with a current task
+ */
+bool preempt_needed(Cpu_t *cpu) {
+	Task_t *task = cpu->current_task;
+
+	if(is_rt_task(task)) {
+		return cpu->num_rt_queued > 0 && sched_edf.preempt_check(cpu->rt_rq, task);
+	}
+	return cpu->num_rt_queued > 0 ||
+		(cpu->num_queued > 0 && sched_class->preempt_check(cpu->rq, task));
+}
+
+
+
+/*
+ * Function: scheduler
+ * -------------------
+ *  Schedules the task the policy picks (for the MLFQ, the one having
+ *  the highest priority) to be the current task, if there is none or 
+ *  the policy preempts the current one.
+ *
+ *  NOTE:
+ *  a. The task to be currently executed is taken off the run queue.
+ *  b. On Pre-emption of a task by another task, the preempted task 
+ *  	is put back on the run queue (for the MLFQ, at the end of its
+ *  	associated queue).
+ *  c. A CPU with nothing to run first tries to steal a task from
+ *  	another CPU.
+ *
+ *  cpu: CPU to schedule
+ *  tick: Clock tick at which the scheduling decision is made
+ */
+void scheduler(Cpu_t *cpu, int tick) {
+    if (cpu->current_task == NULL && cpu->num_queued == 0 && cpu->num_rt_queued == 0 && num_cpus > 1) {
+        steal_task(cpu);
+    }
+
+    if (cpu->num_queued == 0 && cpu->num_rt_queued == 0) {
+        return;
+    }
+
+    // Schedule next task if there is not currently a task
+    if (cpu->current_task == NULL) {
+        cpu->current_task = pick_next_task(cpu, tick);
+    } 
+    // schedule a more deserving task if there is one
+    else if (preempt_needed(cpu)) {
+        enqueue_task(cpu, cpu->current_task, ENQUEUE_PREEMPTED, tick);
+        cpu->current_task = pick_next_task(cpu, tick);
+    }
+}
+
+
+
+/*
+ * Function: ticks_until_multiple
+ * ------------------------------
+ *  Returns the number of ticks from `tick` to the next multiple of
+ *  `interval` strictly after it.
+ */
+int ticks_until_multiple(int tick, int interval) {
+	return interval - tick % interval;
+}
+
+
+
+/*
+ * Function: next_event_span
+ * -------------------------
+ *  Returns the number of ticks, starting at `tick`, during which
+ *  nothing but the progress of the current tasks can happen: the span
+ *  ends at the next instruction, the next boost (or, with adaptive 
+ *  boosts, the next task to starve) or rebalance, the next
+ *  I/O completion, real-time release or replenishment, a pending 
+ *  preemption, or the end of any CPU's current time slice or burst,
+ *  whichever comes first. Must be called
+ *  after `scheduler()`.
+ *
+ *  tick: Clock tick
+ *  next_instruction: The next instruction still to be handled
+ */
+int next_event_span(int tick, Instruction_t *next_instruction) {
+	int span = INT_MAX;
+	bool all_idle = true;
+
+	if(sched_config.boost_target > 0) {
+		for(int c = 0; c < num_cpus; c++) {
+			int oldest = sched_class->oldest_waiting(cpus[c].rq);
+
+			if(oldest != INT_MAX && oldest + sched_config.boost_target - tick < span) {
+				span = oldest + sched_config.boost_target - tick;
+			}
+		}
+	} else if(sched_class->boost != NULL) {
+		span = ticks_until_multiple(tick, sched_config.boost_interval);
+	}
+	if(!next_instruction->is_eof && next_instruction->event_tick - tick < span) {
+		span = next_instruction->event_tick - tick;
+	}
+	if(num_cpus > 1 && balance_interval > 0 && ticks_until_multiple(tick, balance_interval) < span) {
+		span = ticks_until_multiple(tick, balance_interval);
+	}
+	for(int d = 0; d < num_devices; d++) {
+		if(devices[d].current_task != NULL) {
+			all_idle = false;
+			if(devices[d].done_at - tick < span) {
+				span = devices[d].done_at - tick;
+			}
+		}
+	}
+	for(int i = 0; i < num_rt_tasks; i++) {
+		Task_t *task = rt_tasks[i];
+
+		if(task->rt_throttled_until >= 0) {
+			all_idle &= task->remaining_burst_time == 0;
+			if(task->rt_throttled_until - tick < span) {
+				span = task->rt_throttled_until - tick;
+			}
+		}
+		if(task->rt_next_release >= 0 && !task->exit_pending && task->rt_next_release - tick < span) {
+			span = task->rt_next_release - tick;
+		}
+	}
+
+	for(int c = 0; c < num_cpus; c++) {
+		Cpu_t *cpu = &cpus[c];
+		Task_t *task = cpu->current_task;
+
+		if(task == NULL) {
+			continue;
+		}
+		all_idle = false;
+
+		// E.g. in the MLFQ, new bursts always join queue 1, so a demoted
+		// task taken from queue 1 is preempted on the next tick if others
+		// are waiting
+		if(preempt_needed(cpu)) {
+			span = 1;
+		}
+		int slice_left = task_class(task)->slice_left(task_rq(cpu, task), task);
+		if(slice_left < span) {
+			span = slice_left;
+		}
+		if(task->remaining_burst_time < span) {
+			span = task->remaining_burst_time;
+		}
+	}
+
+	if(num_cpus > 1) {
+		// A CPU scheduled after an idle one may have just preempted a 
+		// task, e.g. for a real-time task, which the idle one steals on
+		// the next tick
+		bool cpu_idle = false, spare = false;
+
+		for(int c = 0; c < num_cpus; c++) {
+			cpu_idle |= cpus[c].current_task == NULL;
+			spare |= spare_tasks(&cpus[c]) > 0;
+		}
+		if(cpu_idle && spare) {
+			span = 1;
+		}
+	}
+
+	if(all_idle && next_instruction->is_eof) {
+		// Nothing left to run or to arrive: the simulation ends here
+		span = 1;
+	}
+
+	return span < 1 ? 1 : span;
+}
+
+
+
+/*
+ * Function: execute_task
+ * ----------------------
+ *  Executes the current task of every CPU for `span` ticks (By 
+ *  updating the associated remaining times). Sets a CPU's current_task
+ *  to NULL on completion of the current burst.
+ *
+ *  tick: Clock tick of the first tick executed (ONLY For Print statements)
+ *  span: Number of ticks to execute, as given by `next_event_span()`
+ */
+void execute_task(int tick, int span) {
+	int used[MAX_CPUS];
+
+	for(int c = 0; c < num_cpus; c++) {
+		Task_t *task = cpus[c].current_task;
+		used[c] = task == NULL ? 0 : task->burst_time - task->remaining_burst_time;
+	}
+
+	if(output_mode == OUTPUT_TEXT && !compress_output) {
+		for(int i = 0; i < span; i++) {
+			for(int c = 0; c < num_cpus; c++) {
+				output_run(&output, c, tick + i, 1, cpus[c].current_task, used[c] + i);
+			}
+		}
+	} else if(output_mode != OUTPUT_SUMMARY) {
+		for(int c = 0; c < num_cpus; c++) {
+			output_run(&output, c, tick, span, cpus[c].current_task, used[c]);
+		}
+	}
+
+	if(trace_file != NULL) {
+		for(int c = 0; c < num_cpus; c++) {
+			trace_run(&trace, c, tick, span, cpus[c].current_task);
+		}
+	}
+
+	bool cpu_busy = false, io_busy = false;
+	for(int c = 0; c < num_cpus; c++) {
+		cpu_busy |= cpus[c].current_task != NULL;
+	}
+	for(int d = 0; d < num_devices; d++) {
+		io_busy |= devices[d].current_task != NULL;
+	}
+	if(cpu_busy && io_busy) {
+		overlap_ticks += span;
+	} else if(cpu_busy) {
+		cpu_only_ticks += span;
+	} else if(io_busy) {
+		io_only_ticks += span;
+	} else {
+		idle_ticks += span;
+	}
+
+	if(print_histograms) {
+		int num_queued = 0;
+		for(int c = 0; c < num_cpus; c++) {
+			num_queued += cpus[c].num_queued + cpus[c].num_rt_queued;
+		}
+		histogram_record(&queue_length_histogram, num_queued, span);
+	}
+
+	for(int c = 0; c < num_cpus; c++) {
+		Cpu_t *cpu = &cpus[c];
+		Task_t *current_task = cpu->current_task;
+
+		if(current_task == NULL) {
+			cpu->idle_ticks += span;
+			continue;
+		}
+
+        cpu->busy_ticks += span;
+        bool expired = task_class(current_task)->tick(task_rq(cpu, current_task), current_task, span);
+        current_task->total_execution_time += span;
+        current_task->remaining_burst_time -= span;
+        
+        // time slice used up (for the MLFQ, the task is demoted, and a
+        // real-time task is throttled)
+        if (expired && current_task->remaining_burst_time > 0) {
+            cpu->current_task = NULL;
+            if (is_rt_task(current_task)) {
+                throttle_rt_task(current_task, tick + span);
+            } else {
+                enqueue_task(cpu, current_task, ENQUEUE_EXPIRED, tick + span);
+            }
+        }
+
+        // task terminated
+        else if (current_task->remaining_burst_time == 0) {
+            task_class(current_task)->dequeue(task_rq(cpu, current_task), current_task, DEQUEUE_SLEEP);
+            if (is_rt_task(current_task)) {
+                complete_rt_job(current_task, tick + span);
+                if (expired) {
+                    throttle_rt_task(current_task, tick + span);
+                }
+            } else {
+                record_burst(current_task, tick + span);
+            }
+            if (current_task->io_device >= 0) {
+                start_io(current_task, tick + span);
+            } else if (current_task->exit_pending) {
+                report_exit(current_task, tick + span);
+            }
+            cpu->current_task = NULL;
+        }
+	}
+}
+
+
+
+/*
+ * Function: all_cpus_idle
+ * -----------------------
+ *  Returns true if no CPU has a current task or a waiting task, no
+ *  device has a request and no throttled real-time task has a job.
+ */
+bool all_cpus_idle() {
+	for(int c = 0; c < num_cpus; c++) {
+		if(cpus[c].current_task != NULL || cpus[c].num_queued != 0 || cpus[c].num_rt_queued != 0) {
+			return false;
+		}
+	}
+	for(int i = 0; i < num_rt_tasks; i++) {
+		if(rt_tasks[i]->remaining_burst_time > 0) {
+			return false;
+		}
+	}
+	for(int d = 0; d < num_devices; d++) {
+		if(devices[d].current_task != NULL) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+/*
+ * Function: report_stream
+ * -----------------------
+ *  Returns the stream for the reports that follow the simulation: 
+ *  standard output, unless it carries the binary event log.
+ */
+FILE *report_stream() {
+	return output_mode == OUTPUT_BINARY ? stderr : stdout;
+}
+
+
+
+/*
+ * Function: print_cpu_report
+ * --------------------------
+ *  With more than one CPU, prints the utilization and migrations of
+ *  each CPU at the end of the simulation.
+ */
+void print_cpu_report() {
+	int migrations = 0;
+
+	if(num_cpus == 1) {
+		return;
+	}
+
+	for(int c = 0; c < num_cpus; c++) {
+		Cpu_t *cpu = &cpus[c];
+		long ticks = cpu->busy_ticks + cpu->idle_ticks;
+
+		fprintf(report_stream(), "cpu=%02d busy=%ld idle=%ld utilization=%.1f%% migrations_in=%d migrations_out=%d\n",
+			cpu->id, cpu->busy_ticks, cpu->idle_ticks,
+			ticks > 0 ? 100.0 * cpu->busy_ticks / ticks : 0.0,
+			cpu->migrations_in, cpu->migrations_out);
+		migrations += cpu->migrations_in;
+	}
+	fprintf(report_stream(), "migrations=%d\n", migrations);
+}
+
+
+
+/*
+ * Function: print_device_report
  * -----------------------------
- * 	Increments the waiting time/execution time for the tasks 
- * 	that are currently scheduled (In the queue). These values would  
- * 	be later used for the computation of the task waiting time and  
- *	turnaround time.
- */
-void update_task_metrics() { 
-    // update all waiting task metrics
-    Task_t* tempTask;
-    if (!is_empty(queue_1)) {
-        tempTask = queue_1->start;
-        while (tempTask != NULL) {
-            if (tempTask != current_task) {
-                tempTask->total_wait_time++;
-            }
-            tempTask = tempTask->next;
-        }
-    }
-    if (!is_empty(queue_2)) {
-        tempTask = queue_2->start;
-        while (tempTask != NULL) {
-            if (tempTask != current_task) {
-                tempTask->total_wait_time++;
-            }
-            tempTask = tempTask->next;
-        }
-    }
-    if (!is_empty(queue_3)) {
-        tempTask = queue_3->start;
-        while (tempTask != NULL) {
-            if (tempTask != current_task) {
-                tempTask->total_wait_time++;
-            }
-            tempTask = tempTask->next;
-        }
-    }
+ *  If any I/O was requested, prints the utilization of each device and
+ *  how much CPU and I/O time overlapped.
+ *
+ *  last_tick: Last tick simulated
+ */
+void print_device_report(int last_tick) {
+	if(num_devices == 0) {
+		return;
+	}
+
+	for(int d = 0; d < num_devices; d++) {
+		Device_t *device = &devices[d];
+
+		if(device->requests == 0) {
+			continue;
+		}
+		fprintf(report_stream(), "device=%02d requests=%d busy=%ld utilization=%.1f%%\n",
+			d, device->requests, device->busy_ticks, 100.0 * device->busy_ticks / last_tick);
+	}
+	fprintf(report_stream(), "io cpu_only=%ld io_only=%ld overlap=%ld idle=%ld\n",
+		cpu_only_ticks, io_only_ticks, overlap_ticks, idle_ticks);
 }
 
 
 
 /*
- * Function: main
- * --------------
- * argv[1]: Input file/test case.
+ * Function: compare_ints
+ * ----------------------
+ *  qsort() comparator for ints in ascending order.
  */
-int main(int argc, char *argv[]) {
-	int tick = 1;
-	int is_inst_complete = false;
-	
-	validate_args(argc, argv);
-	initialize_vars();
+int compare_ints(const void *a, const void *b) {
+	int x = *(const int *)a;
+	int y = *(const int *)b;
 
-	FILE *fp = fopen(argv[1], "r");
+	return (x > y) - (x < y);
+}
 
-	if(fp == NULL) {
-		fprintf(stderr, "File \"%s\" does not exist.\n", argv[1]);
-		exit(1);
+
+
+/*
+ * Function: nearest_rank
+ * ----------------------
+ *  Returns the `percent`th percentile of the sorted values, by the
+ *  nearest-rank method.
+ *
+ *  sorted: Values in ascending order
+ *  count: Number of values (at least 1)
+ *  percent: Percentile, 1 to 100
+ */
+int nearest_rank(int *sorted, int count, int percent) {
+	return sorted[((long)count * percent + 99) / 100 - 1];
+}
+
+
+
+/*
+ * Function: print_wait_stats
+ * --------------------------
+ *  With --stats, prints the mean, median, 99th percentile (nearest 
+ *  rank) and maximum of the waiting times of the tasks that exited.
+ */
+void print_wait_stats() {
+	double sum = 0;
+
+	if(!print_stats) {
+		return;
+	}
+	if(num_exits == 0) {
+		fprintf(report_stream(), "policy=%s exits=0\n", sched_class->name);
+		return;
 	}
 
-	Instruction_t *curr_instruction = (Instruction_t*) malloc(sizeof(Instruction_t));
-	
+	qsort(wait_times, num_exits, sizeof(int), compare_ints);
+	for(int i = 0; i < num_exits; i++) {
+		sum += wait_times[i];
+	}
+	fprintf(report_stream(), "policy=%s exits=%d wt_mean=%.2f wt_p50=%d wt_p99=%d wt_max=%d\n",
+		sched_class->name, num_exits, sum / num_exits,
+		nearest_rank(wait_times, num_exits, 50),
+		nearest_rank(wait_times, num_exits, 99),
+		wait_times[num_exits - 1]);
+}
+
+
+
+/*
+ * Function: print_histogram
+ * -------------------------
+ *  Prints one line of the --histograms report.
+ *
+ *  metric: Name of what the histogram measures
+ *  queue_name: Queue the values belong to, "all" or "rt"
+ *  histogram: Histogram to report
+ */
+void print_histogram(const char *metric, const char *queue_name, Histogram_t *histogram) {
+	fprintf(report_stream(), "histogram=%s queue=%s count=%lld mean=%.2f p50=%lld p90=%lld p99=%lld p99.9=%lld max=%lld\n",
+		metric, queue_name, histogram->total, histogram_mean(histogram),
+		histogram_percentile(histogram, 50),
+		histogram_percentile(histogram, 90),
+		histogram_percentile(histogram, 99),
+		histogram_percentile(histogram, 99.9),
+		histogram->max);
+}
+
+
+
+/*
+ * Function: print_histogram_report
+ * -------------------------------
+ *  With --histograms, prints the burst latencies, overall and for each
+ *  queue that completed a burst, and the queue length over time.
+ */
+void print_histogram_report() {
+	static const char *metric_names[NUM_METRICS] = { "response", "wait", "turnaround" };
+	char queue_name[16];
+
+	if(!print_histograms) {
+		return;
+	}
+
+	for(int m = 0; m < NUM_METRICS; m++) {
+		print_histogram(metric_names[m], "all", &burst_histograms[m][0]);
+		for(int level = 1; level <= sched_config.num_levels; level++) {
+			if(burst_histograms[m][level].total > 0) {
+				sprintf(queue_name, "%d", level);
+				print_histogram(metric_names[m], queue_name, &burst_histograms[m][level]);
+			}
+		}
+	}
+	print_histogram("queue_length", "all", &queue_length_histogram);
+}
+
+
+
+/*
+ * Function: print_rt_report
+ * -------------------------
+ *  If there were real-time tasks, prints how many of their jobs met,
+ *  missed or were dropped before their deadlines, how often they were
+ *  throttled, and the distributions of their response times and of 
+ *  the lateness of the jobs that missed.
+ */
+void print_rt_report() {
+	if(rt_admitted == 0) {
+		return;
+	}
+
+	fprintf(report_stream(), "rt tasks=%d jobs=%ld met=%ld missed=%ld dropped=%ld miss_rate=%.1f%% throttles=%ld\n",
+		rt_admitted, rt_jobs, rt_met, rt_missed, rt_dropped,
+		rt_jobs > 0 ? 100.0 * (rt_missed + rt_dropped) / rt_jobs : 0.0, rt_throttles);
+	print_histogram("response", "rt", &rt_response_histogram);
+	print_histogram("lateness", "rt", &rt_lateness_histogram);
+}
+
+
+
+/*
+ * Function: run_simulation
+ * ------------------------
+ *  Runs the simulation of the instructions from the source, on state
+ *  set up by `initialize_vars()`. Returns the last tick simulated.
+ *
+ *  source: Where to take the instructions from
+ */
+int run_simulation(Instruction_source_t *source) {
+	int tick = 1;
+	int span;
+	int is_inst_complete = false;
+	Instruction_t instruction;
+	Instruction_t *curr_instruction = &instruction;
+
 	// Read First Instruction
-	read_instruction(fp, curr_instruction);
+	next_instruction(source, curr_instruction);
 
 	if(curr_instruction->is_eof) {
-		fprintf(stderr, "Error reading from the file. The file is empty.\n");
-		exit(1);
+		output_error("Error reading from the file. The file is empty.\n");
 	}
 	while(true) {
+		complete_io(tick);
+		update_rt_servers(tick);
+
 		while(curr_instruction->event_tick == tick) {
 			handle_instruction(curr_instruction, tick);
 
 			// Read Next Instruction
-			read_instruction(fp, curr_instruction);
+			next_instruction(source, curr_instruction);
 			if(curr_instruction->is_eof) {
 				is_inst_complete = true;
 			}
 		}
 		
-		boost(tick);	
+		for(int c = 0; c < num_cpus; c++) {
+			if(sched_config.boost_target > 0) {
+				adaptive_boost(&cpus[c], tick);
+			} else {
+				boost(&cpus[c], tick);
+			}
+		}
+
+		balance(tick);
 
-		scheduler();
+		for(int c = 0; c < num_cpus; c++) {
+			scheduler(&cpus[c], tick);
+		}
 
-		update_task_metrics();
+		span = next_event_span(tick, curr_instruction);
 
-		execute_task(tick);
+		execute_task(tick, span);
 		
-		if(is_inst_complete && is_empty(queue_1) && is_empty(queue_2) && is_empty(queue_3) && current_task == NULL) {
+		if(is_inst_complete && all_cpus_idle()) {
 			break;
 		}
 
-		tick++;
+		tick += span;
+	}
+	return tick + span - 1;
+}
+
+
+
+/*
+ * Sweep state shared by the worker threads.
+ */
+typedef struct Sweep Sweep_t;
+struct Sweep {
+	Instruction_t	*instructions;
+	int				count;
+	int				num_configs;
+	int				next_config;		// Next configuration to hand out
+	pthread_mutex_t	lock;				// Protects `next_config`
+	Sweep_result_t	*results;
+	Sched_config_t	base_config;		// Options parsed on the main thread
+};
+
+
+
+/*
+ * Function: load_instructions
+ * ---------------------------
+ *  Reads the whole case file into an array, which it returns, with
+ *  the number of instructions (not counting the final EOF entry).
+ *
+ *  file: The input test file
+ *  count: Set to the number of instructions
+ */
+Instruction_t *load_instructions(Case_file_t *file, int *count) {
+	int capacity = 1024;
+	Instruction_t *instructions = emalloc(capacity * sizeof(Instruction_t));
+
+	*count = 0;
+	for(;;) {
+		if(*count == capacity) {
+			capacity *= 2;
+			instructions = realloc(instructions, capacity * sizeof(Instruction_t));
+			if(instructions == NULL) {
+				output_error("Out of memory.\n");
+			}
+		}
+		read_instruction(file, &instructions[*count]);
+		if(instructions[*count].is_eof) {
+			return instructions;
+		}
+		(*count)++;
+	}
+}
+
+
+
+/*
+ * Function: collect_results
+ * -------------------------
+ *  Records the results of the simulation just run on the calling 
+ *  thread's state: the number of exits, the mean and 99th percentile
+ *  waiting and turnaround times, and the boosts and context switches.
+ *
+ *  result: Where to record them
+ */
+void collect_results(Sweep_result_t *result) {
+	double sum;
+
+	result->exits = num_exits;
+	if(num_exits > 0) {
+		qsort(wait_times, num_exits, sizeof(int), compare_ints);
+		qsort(turnaround_times, num_exits, sizeof(int), compare_ints);
+		sum = 0;
+		for(int i = 0; i < num_exits; i++) {
+			sum += wait_times[i];
+		}
+		result->wait_mean = sum / num_exits;
+		result->wait_p99 = nearest_rank(wait_times, num_exits, 99);
+		sum = 0;
+		for(int i = 0; i < num_exits; i++) {
+			sum += turnaround_times[i];
+		}
+		result->turnaround_mean = sum / num_exits;
+		result->turnaround_p99 = nearest_rank(turnaround_times, num_exits, 99);
+	}
+	result->boosts = num_boosts;
+	result->switches = 0;
+	for(int c = 0; c < num_cpus; c++) {
+		result->switches += cpus[c].switches;
+	}
+}
+
+
+
+/*
+ * Function: run_sweep_config
+ * --------------------------
+ *  Runs the simulation with the sweep's `index`th configuration, on the
+ *  calling thread's state, and records its results. Configurations are
+ *  numbered with the boost interval varying fastest, then the quantum
+ *  of the last level given, and so on.
+ *
+ *  sweep: Sweep the configuration belongs to
+ *  index: Number of the configuration
+ */
+void run_sweep_config(Sweep_t *sweep, int index) {
+	Sweep_result_t *result = &sweep->results[index];
+	Instruction_source_t source = { NULL, sweep->instructions, sweep->count, 0 };
+	int quanta[MAX_LEVELS];
+
+	result->boost_interval = boost_range.lo + index % range_size(&boost_range) * boost_range.step;
+	index /= range_size(&boost_range);
+	for(int level = num_quanta - 1; level >= 0; level--) {
+		Range_t *range = &quantum_ranges[level];
+		quanta[level] = range->lo + index % range_size(range) * range->step;
+		index /= range_size(range);
+	}
+	set_quanta(&sched_config, quanta);
+	sched_config.boost_interval = result->boost_interval;
+	memcpy(result->time_quantums, sched_config.time_quantums, sizeof(result->time_quantums));
+
+	initialize_vars();
+	run_simulation(&source);
+	output_finish(&output, 0);
+	collect_results(result);
+	free_vars();
+}
+
+
+
+/*
+ * Function: sweep_worker
+ * ----------------------
+ *  Thread body: runs configurations of the sweep until none are left.
+ *  The scheduler options other than the quanta and boost interval are
+ *  copied from the main thread's configuration.
+ *
+ *  arg: The Sweep_t
+ */
+void *sweep_worker(void *arg) {
+	Sweep_t *sweep = arg;
+	int index;
+
+	sched_config = sweep->base_config;
+	for(;;) {
+		pthread_mutex_lock(&sweep->lock);
+		index = sweep->next_config++;
+		pthread_mutex_unlock(&sweep->lock);
+
+		if(index >= sweep->num_configs) {
+			return NULL;
+		}
+		run_sweep_config(sweep, index);
+	}
+}
+
+
+
+/*
+ * Function: print_sweep_results
+ * -----------------------------
+ *  Prints one row per configuration: the quanta of the levels given
+ *  by --quanta, the boost interval, and the mean and 99th percentile
+ *  waiting and turnaround times.
+ *
+ *  sweep: Finished sweep
+ */
+void print_sweep_results(Sweep_t *sweep) {
+	for(int level = 0; level < num_quanta; level++) {
+		printf("%6s%-2d", "q", level + 1);
+	}
+	printf("%8s %7s %10s %8s %10s %8s\n", "boost", "exits", "wt_mean", "wt_p99",
+		"tat_mean", "tat_p99");
+
+	for(int i = 0; i < sweep->num_configs; i++) {
+		Sweep_result_t *result = &sweep->results[i];
+
+		for(int level = 0; level < num_quanta; level++) {
+			printf("%8d", result->time_quantums[level]);
+		}
+		printf("%8d %7d %10.2f %8d %10.2f %8d\n", result->boost_interval,
+			result->exits, result->wait_mean, result->wait_p99,
+			result->turnaround_mean, result->turnaround_p99);
+	}
+}
+
+
+
+/*
+ * Function: run_sweep
+ * -------------------
+ *  Runs every configuration of the sweep on a pool of threads, then
+ *  prints the table of results.
+ *
+ *  file: The input test file
+ */
+void run_sweep(Case_file_t *file) {
+	Sweep_t sweep;
+	pthread_t *threads;
+
+	sweep.instructions = load_instructions(file, &sweep.count);
+	if(sweep.count == 0) {
+		output_error("Error reading from the file. The file is empty.\n");
+	}
+
+	sweep.num_configs = range_size(&boost_range);
+	for(int level = 0; level < num_quanta; level++) {
+		sweep.num_configs *= range_size(&quantum_ranges[level]);
+	}
+	sweep.next_config = 0;
+	sweep.results = emalloc(sweep.num_configs * sizeof(Sweep_result_t));
+	memset(sweep.results, 0, sweep.num_configs * sizeof(Sweep_result_t));
+	sweep.base_config = sched_config;
+	pthread_mutex_init(&sweep.lock, NULL);
+
+	if(num_threads == 0) {
+		num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if(num_threads > sweep.num_configs) {
+		num_threads = sweep.num_configs;
+	}
+	if(num_threads < 1) {
+		num_threads = 1;
+	}
+
+	threads = emalloc(num_threads * sizeof(pthread_t));
+	for(int t = 0; t < num_threads; t++) {
+		if(pthread_create(&threads[t], NULL, sweep_worker, &sweep) != 0) {
+			output_error("Cannot create sweep thread.\n");
+		}
+	}
+	for(int t = 0; t < num_threads; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	print_sweep_results(&sweep);
+
+	pthread_mutex_destroy(&sweep.lock);
+	deallocate(threads);
+	deallocate(sweep.results);
+	deallocate(sweep.instructions);
+}
+
+
+
+/*
+ * Function: run_fixed_boosts
+ * --------------------------
+ *  For --adaptive-boost, runs the simulation of the instructions with
+ *  boosts every `boost_interval` ticks instead, printing, tracing and
+ *  recording histograms of nothing, and records its results to compare
+ *  with the adaptive run's.
+ *
+ *  source: The instructions, read into memory; rewound afterwards
+ *  result: Where to record the results
+ */
+void run_fixed_boosts(Instruction_source_t *source, Sweep_result_t *result) {
+	int saved_output_mode = output_mode;
+	char *saved_trace_file = trace_file;
+	bool saved_print_histograms = print_histograms;
+
+	output_mode = OUTPUT_NONE;
+	trace_file = NULL;
+	print_histograms = false;
+	sched_config.boost_target = 0;
+	memset(result, 0, sizeof(*result));
+
+	initialize_vars();
+	run_simulation(source);
+	output_finish(&output, 0);
+	collect_results(result);
+	free_vars();
+
+	output_mode = saved_output_mode;
+	trace_file = saved_trace_file;
+	print_histograms = saved_print_histograms;
+	sched_config.boost_target = adaptive_target;
+	source->next = 0;
+}
+
+
+
+/*
+ * Function: percent_change
+ * ------------------------
+ *  Returns the change from `before` to `after` as a percentage of
+ *  `before`, or 0 if `before` is 0.
+ */
+double percent_change(double before, double after) {
+	return before == 0 ? 0.0 : 100.0 * (after - before) / before;
+}
+
+
+
+/*
+ * Function: print_boost_report
+ * ----------------------------
+ *  With --adaptive-boost, prints the results of the fixed-interval and
+ *  the adaptive runs, and the change from one to the other.
+ *
+ *  fixed: Results of `run_fixed_boosts()`
+ *  adaptive: Results of the simulation printed
+ */
+void print_boost_report(Sweep_result_t *fixed, Sweep_result_t *adaptive) {
+	FILE *stream = report_stream();
+
+	fprintf(stream, "boost mode=fixed interval=%d boosts=%ld switches=%ld wt_mean=%.2f wt_p99=%d\n",
+		sched_config.boost_interval, fixed->boosts, fixed->switches, fixed->wait_mean, fixed->wait_p99);
+	fprintf(stream, "boost mode=adaptive target=%d boosts=%ld switches=%ld wt_mean=%.2f wt_p99=%d\n",
+		sched_config.boost_target, adaptive->boosts, adaptive->switches, adaptive->wait_mean, adaptive->wait_p99);
+	fprintf(stream, "boost change switches=%+.1f%% wt_p99=%+.1f%%\n",
+		percent_change(fixed->switches, adaptive->switches),
+		percent_change(fixed->wait_p99, adaptive->wait_p99));
+}
+
+
+
+/*
+ * Function: main
+ * --------------
+ * argv[1]: Input file/test case.
+ */
+int main(int argc, char *argv[]) {
+	char *case_file = validate_args(argc, argv);
+	Instruction_source_t source = { NULL, NULL, 0, 0 };
+	Case_file_t file;
+	Sweep_result_t fixed, adaptive;
+	int last_tick;
+
+	if(!case_open(&file, case_file)) {
+		output_error("File \"%s\" does not exist.\n", case_file);
+	}
+
+	if(sweep_mode) {
+		run_sweep(&file);
+		case_close(&file);
+		return 0;
+	}
+
+	// Comparing boosts takes two simulations of the case
+	if(adaptive_target > 0) {
+		source.instructions = load_instructions(&file, &source.count);
+		run_fixed_boosts(&source, &fixed);
+	} else {
+		source.file = &file;
+	}
+
+	initialize_vars();
+	if(trace_file != NULL) {
+		trace_open(&trace, trace_file, num_cpus, sched_config.num_levels);
+	}
+	last_tick = run_simulation(&source);
+
+	case_close(&file);
+	if(trace_file != NULL) {
+		trace_close(&trace);
+	}
+	output_finish(&output, last_tick);
+	print_cpu_report();
+	print_device_report(last_tick);
+	print_rt_report();
+
+	print_wait_stats();
+	print_histogram_report();
+	if(adaptive_target > 0) {
+		memset(&adaptive, 0, sizeof(adaptive));
+		collect_results(&adaptive);
+		print_boost_report(&fixed, &adaptive);
+		deallocate(source.instructions);
 	}
 
-	fclose(fp);
-	deallocate(curr_instruction);
-	deallocate(queue_1);
-	deallocate(queue_2);
-	deallocate(queue_3);
+	free_vars();
 }
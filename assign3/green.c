@@ -0,0 +1,222 @@
+/*
+ * green.c
+ *
+ * Switching from the SIGALRM handler to the scheduler's context relies
+ * on glibc's swapcontext() working from a signal handler, as it does on
+ * Linux: the preempted thread resumes inside the handler, and its 
+ * return restores the thread's signal mask.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "green.h"
+
+/*
+ * Why a thread went back to the scheduler.
+ */
+#define SWITCH_YIELD        0
+#define SWITCH_EXPIRED      1   // Quantum used up
+#define SWITCH_PREEMPTED    2   // A higher queue has work
+#define SWITCH_REQUEUED     3   // Put back on the run queue by a boost
+#define SWITCH_EXITED       4
+
+static const Sched_class_t *sched_class;
+static Sched_config_t config;
+static void *rq;
+static int num_queued;
+static int next_id;
+static int tick_us;
+static size_t stack_size;
+
+static Green_thread_t *current;         // Running thread, or NULL in the scheduler
+static ucontext_t scheduler_context;
+static int switch_reason;
+static Green_stats_t stats;
+static sigset_t alarm_set;
+
+
+static void switch_to_scheduler(int reason) {
+    switch_reason = reason;
+    swapcontext(&current->context, &scheduler_context);
+}
+
+
+static void thread_main(void) {
+    current->fn(current->arg);
+    sigprocmask(SIG_BLOCK, &alarm_set, NULL);
+    switch_to_scheduler(SWITCH_EXITED);
+}
+
+
+/*
+ * SIGALRM handler: charge the running thread for the tick, and switch
+ * to the scheduler if the class no longer wants it to run.
+ */
+static void on_tick(int sig) {
+    Green_thread_t *thread = current;
+
+    (void)sig;
+    stats.ticks++;
+    if (thread == NULL) {
+        return;
+    }
+
+    if (sched_class->boost != NULL && stats.ticks % config.boost_interval == 0 &&
+        sched_class->boost(rq, &thread->task)) {
+        num_queued++;
+        stats.preemptions++;
+        switch_to_scheduler(SWITCH_REQUEUED);
+    } else if (sched_class->tick(rq, &thread->task, 1)) {
+        stats.preemptions++;
+        switch_to_scheduler(SWITCH_EXPIRED);
+    } else if (num_queued > 0 && sched_class->preempt_check(rq, &thread->task)) {
+        stats.preemptions++;
+        switch_to_scheduler(SWITCH_PREEMPTED);
+    }
+}
+
+
+/*
+ * Set up the runtime. `tick_us` is the tick length in microseconds, or
+ * 0 for purely cooperative threads.
+ */
+void green_init(const Sched_class_t *class, const Sched_config_t *sched_config, int tick, size_t stack) {
+    sched_class = class;
+    config = *sched_config;
+    rq = sched_class->create(&config);
+    num_queued = 0;
+    next_id = 0;
+    tick_us = tick;
+    stack_size = stack;
+    current = NULL;
+    memset(&stats, 0, sizeof(stats));
+    sigemptyset(&alarm_set);
+    sigaddset(&alarm_set, SIGALRM);
+}
+
+
+/*
+ * Create a thread running fn(arg), queued as a new task would be.
+ * Returns its id.
+ */
+int green_spawn(void (*fn)(void *), void *arg) {
+    Green_thread_t *thread;
+    sigset_t old;
+
+    sigprocmask(SIG_BLOCK, &alarm_set, &old);
+    thread = emalloc(sizeof(Green_thread_t));
+    memset(thread, 0, sizeof(Green_thread_t));
+    thread->stack = emalloc(stack_size);
+    thread->fn = fn;
+    thread->arg = arg;
+    thread->task.id = next_id++;
+    thread->task.current_queue = 1;
+
+    getcontext(&thread->context);
+    thread->context.uc_stack.ss_sp = thread->stack;
+    thread->context.uc_stack.ss_size = stack_size;
+    thread->context.uc_link = NULL;
+    sigdelset(&thread->context.uc_sigmask, SIGALRM);
+    makecontext(&thread->context, thread_main, 0);
+
+    sched_class->enqueue(rq, &thread->task, ENQUEUE_WAKEUP);
+    num_queued++;
+    sigprocmask(SIG_SETMASK, &old, NULL);
+    return thread->task.id;
+}
+
+
+/*
+ * Give up the CPU. The thread stays in its queue and goes to its end.
+ */
+void green_yield(void) {
+    sigset_t old;
+
+    sigprocmask(SIG_BLOCK, &alarm_set, &old);
+    stats.yields++;
+    switch_to_scheduler(SWITCH_YIELD);
+    sigprocmask(SIG_SETMASK, &old, NULL);
+}
+
+
+int green_self(void) {
+    return current == NULL ? -1 : current->task.id;
+}
+
+
+/*
+ * Run the threads until all have returned. The runtime must then be set
+ * up again with green_init() before it is used again.
+ */
+void green_run(void) {
+    struct sigaction action, old_action;
+    struct itimerval timer = { { 0, 0 }, { 0, 0 } };
+    sigset_t old_mask;
+    Task_t *task;
+
+    sigprocmask(SIG_BLOCK, &alarm_set, &old_mask);
+    if (tick_us > 0) {
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = on_tick;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGALRM, &action, &old_action);
+        timer.it_interval.tv_sec = tick_us / 1000000;
+        timer.it_interval.tv_usec = tick_us % 1000000;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_REAL, &timer, NULL);
+    }
+
+    while ((task = sched_class->pick_next(rq)) != NULL) {
+        Green_thread_t *thread = (Green_thread_t *)task;
+
+        num_queued--;
+        stats.switches++;
+        current = thread;
+        swapcontext(&scheduler_context, &thread->context);
+        current = NULL;
+
+        switch (switch_reason) {
+        case SWITCH_YIELD:
+        case SWITCH_PREEMPTED:
+            sched_class->enqueue(rq, task, ENQUEUE_PREEMPTED);
+            num_queued++;
+            break;
+        case SWITCH_EXPIRED:
+            sched_class->enqueue(rq, task, ENQUEUE_EXPIRED);
+            num_queued++;
+            break;
+        case SWITCH_REQUEUED:
+            break;
+        case SWITCH_EXITED:
+            sched_class->dequeue(rq, task, DEQUEUE_SLEEP);
+            free(thread->stack);
+            free(thread);
+            break;
+        }
+    }
+
+    if (tick_us > 0) {
+        sigset_t pending;
+        int sig;
+
+        memset(&timer, 0, sizeof(timer));
+        setitimer(ITIMER_REAL, &timer, NULL);
+        // Take a last tick that is still pending, or the old action gets it
+        sigpending(&pending);
+        if (sigismember(&pending, SIGALRM)) {
+            sigwait(&alarm_set, &sig);
+        }
+        sigaction(SIGALRM, &old_action, NULL);
+    }
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    sched_class->destroy(rq);
+}
+
+
+const Green_stats_t *green_stats(void) {
+    return &stats;
+}
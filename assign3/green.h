@@ -0,0 +1,46 @@
+#ifndef _GREEN_H_
+#define _GREEN_H_
+
+#include <stddef.h>
+#include <ucontext.h>
+#include "queue.h"
+#include "sched.h"
+
+/*
+ * User-level threads: coroutines on ucontext(3) stacks, run one at a 
+ * time on the calling kernel thread and scheduled by a scheduling 
+ * class of sched.h, normally `sched_mlfq`. A thread runs until it 
+ * returns or calls green_yield() (keeping its queue), or, with a tick
+ * set, until a timer tick (SIGALRM) finds its quantum used up (it is
+ * demoted), a higher queue with work, or a boost. Ticks arriving while
+ * the scheduler itself runs are held until the next thread starts.
+ *
+ * A thread may be preempted anywhere, so with a tick set, threads must
+ * block SIGALRM around calls that are not async-signal-safe (malloc, 
+ * stdio, ...); green_spawn() and green_yield() do so themselves.
+ */
+typedef struct Green_thread Green_thread_t;
+struct Green_thread {
+    Task_t      task;           // First, so a Task_t * is its Green_thread_t *
+    ucontext_t  context;
+    void        *stack;
+    void        (*fn)(void *);
+    void        *arg;
+};
+
+typedef struct Green_stats Green_stats_t;
+struct Green_stats {
+    long        switches;       // Threads resumed by the scheduler
+    long        yields;
+    long        preemptions;    // Quantum used up, higher queue, or boost
+    long        ticks;
+};
+
+void green_init(const Sched_class_t *, const Sched_config_t *, int tick_us, size_t stack_size);
+int green_spawn(void (*fn)(void *), void *arg);
+void green_yield(void);
+int green_self(void);
+void green_run(void);
+const Green_stats_t *green_stats(void);
+
+#endif
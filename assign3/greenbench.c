@@ -0,0 +1,267 @@
+/*
+ * greenbench.c
+ *
+ * Benchmark of the green thread runtime (green.c) against pthreads.
+ * --------------------
+ * 	1) Switch cost: each of n threads yields m times, with green_yield()
+ * 	   or sched_yield(), and the time is divided by the number of 
+ * 	   switches.
+ * 	2) Throughput: each of n threads runs a CPU-bound loop of w
+ * 	   iterations, green threads under the MLFQ with a SIGALRM tick and
+ * 	   pthreads under the kernel's scheduler. The total time and the 
+ * 	   mean and maximum completion times are reported.
+ * 	The process is pinned to one core, so that both kinds of thread 
+ * 	share a single CPU.
+ *
+ * Input: Command Line args
+ * ------------------------
+ * 	./greenbench [--threads=n] [--yields=m] [--work=w] [--tick=us]
+ *
+ * 	--threads=<n>  Number of threads (default 1000).
+ * 	--yields=<m>   Yields per thread in the switch benchmark (default 100).
+ * 	--work=<w>     Loop iterations per thread (default 1000000).
+ * 	--tick=<us>    Green thread tick (default 1000).
+ *
+ * Output:
+ * -----------------------
+ * 	One line per benchmark and kind of thread.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "green.h"
+#include "sched.h"
+
+#define STACK_SIZE (64 * 1024)
+#define BOOST_INTERVAL 25
+
+
+int num_threads = 1000;
+int num_yields = 100;
+long work = 1000000;
+int tick_us = 1000;
+
+Sched_config_t sched_config = {
+	.num_levels = 3,
+	.time_quantums = { 2, 4, 8 },
+	.demote_step = 1,
+	.boost_interval = BOOST_INTERVAL,
+};
+
+double start_time;
+double *completion_times;			// Of each thread, from `start_time`
+pthread_barrier_t barrier;
+
+
+
+/*
+ * Function: now
+ * -------------
+ *  Returns the monotonic clock in seconds.
+ */
+double now() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+
+/*
+ * Function: spin
+ * --------------
+ *  Runs `work` iterations of a loop the compiler cannot remove.
+ */
+void spin() {
+	volatile unsigned long sink = 0;
+
+	for(long i = 0; i < work; i++) {
+		sink += i;
+	}
+}
+
+
+
+void green_yielder(void *arg) {
+	(void)arg;
+	for(int i = 0; i < num_yields; i++) {
+		green_yield();
+	}
+}
+
+
+
+void *pthread_yielder(void *arg) {
+	(void)arg;
+	pthread_barrier_wait(&barrier);
+	for(int i = 0; i < num_yields; i++) {
+		sched_yield();
+	}
+	return NULL;
+}
+
+
+
+void green_worker(void *arg) {
+	spin();
+	completion_times[(long)arg] = now() - start_time;
+}
+
+
+
+void *pthread_worker(void *arg) {
+	pthread_barrier_wait(&barrier);
+	spin();
+	completion_times[(long)arg] = now() - start_time;
+	return NULL;
+}
+
+
+
+/*
+ * Function: run_pthreads
+ * ----------------------
+ *  Runs `num_threads` pthreads of the function, which waits on the 
+ *  barrier first, and returns the time from the barrier's release
+ *  until all have finished.
+ */
+double run_pthreads(void *(*fn)(void *)) {
+	pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+	pthread_attr_t attr;
+	double elapsed;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, STACK_SIZE);
+	pthread_barrier_init(&barrier, NULL, num_threads + 1);
+	for(long t = 0; t < num_threads; t++) {
+		if(pthread_create(&threads[t], &attr, fn, (void *)t) != 0) {
+			fprintf(stderr, "Cannot create thread %ld.\n", t);
+			exit(1);
+		}
+	}
+	start_time = now();
+	pthread_barrier_wait(&barrier);
+	for(int t = 0; t < num_threads; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	elapsed = now() - start_time;
+
+	pthread_barrier_destroy(&barrier);
+	pthread_attr_destroy(&attr);
+	free(threads);
+	return elapsed;
+}
+
+
+
+/*
+ * Function: run_green
+ * -------------------
+ *  Runs `num_threads` green threads of the function with the given 
+ *  tick, and returns the time until all have finished.
+ */
+double run_green(void (*fn)(void *), int tick) {
+	green_init(&sched_mlfq, &sched_config, tick, STACK_SIZE);
+	for(long t = 0; t < num_threads; t++) {
+		green_spawn(fn, (void *)t);
+	}
+	start_time = now();
+	green_run();
+	return now() - start_time;
+}
+
+
+
+/*
+ * Function: print_completions
+ * ---------------------------
+ *  Prints the throughput line of one kind of thread.
+ */
+void print_completions(const char *kind, double elapsed) {
+	double sum = 0, max = 0;
+
+	for(int t = 0; t < num_threads; t++) {
+		sum += completion_times[t];
+		if(completion_times[t] > max) {
+			max = completion_times[t];
+		}
+	}
+	printf("throughput %-7s threads=%d total=%.3fs tasks_per_s=%.0f completion_mean=%.3fs completion_max=%.3fs\n",
+		kind, num_threads, elapsed, num_threads / elapsed, sum / num_threads, max);
+}
+
+
+
+/*
+ * Function: validate_args
+ * -----------------------
+ */
+void validate_args(int argc, char *argv[]) {
+	for(int i = 1; i < argc; i++) {
+		if(strncmp(argv[i], "--threads=", 10) == 0) {
+			num_threads = atoi(argv[i] + 10);
+		} else if(strncmp(argv[i], "--yields=", 9) == 0) {
+			num_yields = atoi(argv[i] + 9);
+		} else if(strncmp(argv[i], "--work=", 7) == 0) {
+			work = atol(argv[i] + 7);
+		} else if(strncmp(argv[i], "--tick=", 7) == 0) {
+			tick_us = atoi(argv[i] + 7);
+		} else {
+			fprintf(stderr, "usage: greenbench [--threads=n] [--yields=m] [--work=w] [--tick=us]\n");
+			exit(1);
+		}
+	}
+	if(num_threads < 1 || num_yields < 0 || work < 0 || tick_us < 1) {
+		fprintf(stderr, "Invalid argument\n");
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: main
+ * --------------
+ */
+int main(int argc, char *argv[]) {
+	const Green_stats_t *stats;
+	cpu_set_t cpus;
+	double elapsed;
+
+	validate_args(argc, argv);
+	completion_times = calloc(num_threads, sizeof(double));
+
+	CPU_ZERO(&cpus);
+	CPU_SET(sched_getcpu(), &cpus);
+	if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+		perror("sched_setaffinity");
+		exit(1);
+	}
+
+	elapsed = run_green(green_yielder, 0);
+	stats = green_stats();
+	printf("switch     green   threads=%d switches=%ld ns_per_switch=%.1f\n",
+		num_threads, stats->switches, elapsed * 1e9 / stats->switches);
+	elapsed = run_pthreads(pthread_yielder);
+	printf("switch     pthread threads=%d switches=%ld ns_per_switch=%.1f\n",
+		num_threads, (long)num_threads * num_yields, 
+		elapsed * 1e9 / ((long)num_threads * num_yields + 1));
+
+	elapsed = run_green(green_worker, tick_us);
+	stats = green_stats();
+	print_completions("green", elapsed);
+	printf("           green   ticks=%ld preemptions=%ld switches=%ld\n",
+		stats->ticks, stats->preemptions, stats->switches);
+	elapsed = run_pthreads(pthread_worker);
+	print_completions("pthread", elapsed);
+
+	free(completion_times);
+	return 0;
+}
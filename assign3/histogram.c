@@ -0,0 +1,112 @@
+/*
+ * histogram.c
+ *
+ * Bucketing after Gil Tene's HdrHistogram (http://hdrhistogram.org).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "queue.h"
+#include "histogram.h"
+
+#define SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define MAX_VALUE 0x7fffffffLL         // Larger values are counted as this
+#define NUM_BUCKETS ((31 - HISTOGRAM_SUB_BITS + 1) * SUB_BUCKETS)
+
+
+/*
+ * Index of the bucket holding the value. Values with their top bit at
+ * position `msb` >= HISTOGRAM_SUB_BITS keep their top
+ * HISTOGRAM_SUB_BITS + 1 bits.
+ */
+static int bucket_of(long long value) {
+    int msb;
+
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+    msb = 63 - __builtin_clzll(value);
+    return (msb - HISTOGRAM_SUB_BITS + 1) * SUB_BUCKETS +
+        (int)(value >> (msb - HISTOGRAM_SUB_BITS)) - SUB_BUCKETS;
+}
+
+
+/*
+ * Largest value counted in the bucket.
+ */
+static long long highest_in_bucket(int bucket) {
+    int group = bucket / SUB_BUCKETS;
+    long long top;
+
+    if (group == 0) {
+        return bucket;
+    }
+    // Top bits of the bucket's values, then all ones below them
+    top = bucket - group * SUB_BUCKETS + SUB_BUCKETS;
+    return ((top + 1) << (group - 1)) - 1;
+}
+
+
+void histogram_init(Histogram_t *histogram) {
+    memset(histogram, 0, sizeof(Histogram_t));
+}
+
+
+void histogram_free(Histogram_t *histogram) {
+    free(histogram->counts);
+    histogram_init(histogram);
+}
+
+
+/*
+ * Count `count` occurrences of the value (negative values count as 0).
+ */
+void histogram_record(Histogram_t *histogram, long long value, long long count) {
+    if (histogram->counts == NULL) {
+        histogram->counts = emalloc(NUM_BUCKETS * sizeof(long long));
+        memset(histogram->counts, 0, NUM_BUCKETS * sizeof(long long));
+    }
+    if (value < 0) {
+        value = 0;
+    } else if (value > MAX_VALUE) {
+        value = MAX_VALUE;
+    }
+
+    histogram->counts[bucket_of(value)] += count;
+    histogram->total += count;
+    histogram->sum += (double)value * count;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+
+double histogram_mean(const Histogram_t *histogram) {
+    return histogram->total == 0 ? 0.0 : histogram->sum / histogram->total;
+}
+
+
+/*
+ * The smallest value (to the histogram's precision) that at least
+ * `percentile` percent of the recorded values do not exceed.
+ */
+long long histogram_percentile(const Histogram_t *histogram, double percentile) {
+    long long rank, seen = 0;
+
+    if (histogram->total == 0) {
+        return 0;
+    }
+    rank = (long long)(percentile / 100.0 * histogram->total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (int bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        seen += histogram->counts[bucket];
+        if (seen >= rank) {
+            long long value = highest_in_bucket(bucket);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
@@ -0,0 +1,28 @@
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+/*
+ * Log-linear histogram of non-negative values, in the manner of
+ * HdrHistogram: values below 2^HISTOGRAM_SUB_BITS are counted exactly,
+ * and each larger power-of-two range is split into 2^HISTOGRAM_SUB_BITS
+ * equal buckets, so any value is known to within 1 part in 128 while
+ * the whole int range takes a few thousand buckets. Buckets are only
+ * allocated once something is recorded.
+ */
+#define HISTOGRAM_SUB_BITS 7
+
+typedef struct Histogram Histogram_t;
+struct Histogram {
+    long long   *counts;
+    long long   total;          // Sum of the counts
+    double      sum;            // Sum of the values, for the mean
+    long long   max;
+};
+
+void histogram_init(Histogram_t *);
+void histogram_free(Histogram_t *);
+void histogram_record(Histogram_t *, long long value, long long count);
+double histogram_mean(const Histogram_t *);
+long long histogram_percentile(const Histogram_t *, double percentile);
+
+#endif
@@ -0,0 +1,580 @@
+/*
+ * mlfqrun.c
+ *
+ * Run a feedbackq test case with real processes.
+ * --------------------
+ * 	Every Task of the case file is a child process that spins on the
+ * 	CPU, and the Multi-Level Feedback Queue of feedbackq.c (the same
+ * 	`sched_mlfq` class: 3 queues with quanta 2, 4 and 8, demotion and
+ * 	a boost every BOOST_INTERVAL ticks) decides which one runs, with
+ * 	SIGCONT and SIGSTOP. Ticks are real time, from a timerfd, and a
+ * 	burst completes once its process has had as much CPU time as the
+ * 	burst's ticks, as read from /proc/<pid>/stat. The children are
+ * 	pinned to one core, so the schedule is the only thing sharing it
+ * 	out; any time they do not get shows up as longer bursts, and as
+ * 	waiting and turnaround times above feedbackq's.
+ *
+ * 	CPU time is counted by the kernel in clock ticks (usually 10ms),
+ * 	so ticks much shorter than that cannot be measured. Burst progress
+ * 	is rounded to the nearest tick.
+ *
+ * Input: Command Line args
+ * ------------------------
+ * 	./mlfqrun [options] <input_test_case_file>
+ * 	e.g.
+ * 	     ./mlfqrun --tick=50 test1.txt
+ *
+ * 	--tick=<ms>    Length of a tick (default DEFAULT_TICK_MS, 20).
+ * 	--core=<n>     Core the children run on (default 0).
+ *
+ * 	The case file is as for feedbackq, without I/O requests.
+ *
+ * Output:
+ * -----------------------
+ * 	The lines feedbackq prints, as each tick ends, so that the two can
+ * 	be compared with diff(1); `used` is the CPU time the process has
+ * 	had in the burst. Then, on standard error, the ticks run, the
+ * 	ticks the children were scheduled, the CPU time they got (in
+ * 	ticks) and the number of ticks the timer fired before the previous
+ * 	tick had been handled.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "queue.h"
+#include "task_table.h"
+#include "sched.h"
+#include "output.h"
+#include "caseio.h"
+
+#define BOOST_INTERVAL 25
+#define DEFAULT_TICK_MS 20
+
+
+/*
+ * The process of a task, found by the task's slot in the task table.
+ */
+typedef struct Child Child_t;
+struct Child {
+	pid_t		pid;
+	long		burst_cpu_start;		// CPU time (clock ticks) when the burst started
+};
+
+
+Sched_config_t sched_config = {
+	.num_levels = 3,
+	.time_quantums = { 2, 4, 8 },
+	.demote_step = 1,
+	.boost_interval = BOOST_INTERVAL,
+};
+const Sched_class_t *sched_class = &sched_mlfq;
+void *rq;
+int num_queued = 0;
+Task_t *current_task = NULL;			// Task the schedule gives the CPU
+Task_t *running_task = NULL;			// Task whose process is continued
+
+Child_t *children;
+int children_capacity = 0;
+
+Output_t output;
+int tick_ms = DEFAULT_TICK_MS;
+int core = 0;
+long clock_ticks_per_second;
+
+long scheduled_ticks = 0;
+long cpu_clock_ticks = 0;				// Of the children that exited
+long overruns = 0;
+
+
+
+/*
+ * Function: child_of
+ * ------------------
+ *  Returns the process record of the task, growing the table as
+ *  needed.
+ */
+Child_t *child_of(Task_t *task) {
+	if(task->slot >= children_capacity) {
+		int capacity = children_capacity == 0 ? 1024 : children_capacity;
+
+		while(capacity <= task->slot) {
+			capacity *= 2;
+		}
+		children = realloc(children, capacity * sizeof(Child_t));
+		if(children == NULL) {
+			fprintf(stderr, "Out of memory.\n");
+			exit(1);
+		}
+		children_capacity = capacity;
+	}
+	return &children[task->slot];
+}
+
+
+
+/*
+ * Function: cpu_time
+ * ------------------
+ *  Returns the CPU time (user and system, in clock ticks) the process
+ *  has had, from fields 14 and 15 of /proc/<pid>/stat.
+ */
+long cpu_time(pid_t pid) {
+	char path[64], buffer[1024];
+	unsigned long utime, stime;
+	char *p;
+	ssize_t n;
+	int fd;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+	fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		perror(path);
+		exit(1);
+	}
+	n = read(fd, buffer, sizeof(buffer) - 1);
+	close(fd);
+	buffer[n < 0 ? 0 : n] = '\0';
+
+	// The command name may contain anything, but ends at the last ')'
+	p = strrchr(buffer, ')');
+	if(p == NULL || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+		&utime, &stime) != 2) {
+		fprintf(stderr, "Cannot read the CPU time of process %d.\n", (int)pid);
+		exit(1);
+	}
+	return utime + stime;
+}
+
+
+
+/*
+ * Function: burst_progress
+ * ------------------------
+ *  Returns the CPU time the task's process has had in its current
+ *  burst, rounded to the nearest tick.
+ */
+int burst_progress(Task_t *task) {
+	Child_t *child = child_of(task);
+	long ms = (cpu_time(child->pid) - child->burst_cpu_start) * 1000 / clock_ticks_per_second;
+
+	return (ms + tick_ms / 2) / tick_ms;
+}
+
+
+
+/*
+ * Function: spawn_child
+ * ---------------------
+ *  Starts the task's process, which spins on `core` once continued,
+ *  and waits until it has stopped itself.
+ */
+void spawn_child(Task_t *task) {
+	Child_t *child = child_of(task);
+	int status;
+
+	child->pid = fork();
+	if(child->pid < 0) {
+		perror("fork");
+		exit(1);
+	}
+
+	if(child->pid == 0) {
+		volatile unsigned long spins = 0;
+		cpu_set_t cpus;
+
+		prctl(PR_SET_PDEATHSIG, SIGKILL);
+		CPU_ZERO(&cpus);
+		CPU_SET(core, &cpus);
+		if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+			perror("sched_setaffinity");
+			_exit(1);
+		}
+		raise(SIGSTOP);
+		for(;;) {
+			spins++;
+		}
+	}
+
+	if(waitpid(child->pid, &status, WUNTRACED) < 0 || !WIFSTOPPED(status)) {
+		fprintf(stderr, "Process of task %d did not start.\n", task->id);
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: stop_child
+ * --------------------
+ *  Stops the task's process and waits until it has stopped, so that
+ *  its CPU time no longer changes.
+ */
+void stop_child(Task_t *task) {
+	int status;
+
+	kill(child_of(task)->pid, SIGSTOP);
+	if(waitpid(child_of(task)->pid, &status, WUNTRACED) < 0 || !WIFSTOPPED(status)) {
+		fprintf(stderr, "Process of task %d did not stop.\n", task->id);
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: dispatch
+ * ------------------
+ *  Makes the process of `current_task` the one that runs, stopping the
+ *  one that ran before.
+ */
+void dispatch() {
+	if(running_task == current_task) {
+		return;
+	}
+	if(running_task != NULL) {
+		stop_child(running_task);
+	}
+	if(current_task != NULL) {
+		kill(child_of(current_task)->pid, SIGCONT);
+	}
+	running_task = current_task;
+}
+
+
+
+/*
+ * Function: enqueue_task
+ * ----------------------
+ *  Adds the task to the run queue, waiting from `tick`.
+ */
+void enqueue_task(Task_t *task, int reason, int tick) {
+	task->enqueued_at = tick;
+	sched_class->enqueue(rq, task, reason);
+	num_queued++;
+}
+
+
+
+/*
+ * Function: pick_next_task
+ * ------------------------
+ *  Takes the task to run off the run queue, adding the ticks it spent
+ *  waiting to its `total_wait_time`.
+ */
+Task_t *pick_next_task(int tick) {
+	Task_t *task = sched_class->pick_next(rq);
+
+	if(task != NULL) {
+		num_queued--;
+		task->total_wait_time += tick - task->enqueued_at;
+	}
+	return task;
+}
+
+
+
+/*
+ * Function: report_exit
+ * ---------------------
+ *  Prints the exit line for the task, which has no unfinished burst,
+ *  and ends its process.
+ */
+void report_exit(Task_t *task, int tick) {
+	Child_t *child = child_of(task);
+	int status;
+
+	if(running_task == task) {
+		stop_child(task);
+		running_task = NULL;
+	}
+	cpu_clock_ticks += cpu_time(child->pid);
+	kill(child->pid, SIGKILL);
+	waitpid(child->pid, &status, 0);
+
+	output_exit(&output, tick, task->id, task->total_wait_time,
+		task->total_wait_time + task->total_execution_time);
+	task_table_release(task);
+}
+
+
+
+/*
+ * Function: handle_instruction
+ * ----------------------------
+ *  Processes the instruction as feedbackq does, starting the process
+ *  of a new task.
+ */
+void handle_instruction(Instruction_t *instruction, int tick) {
+	Task_t *task = task_table_lookup(instruction->task_id);
+
+	if(instruction->burst_time == 0) {
+		if(task != NULL) {
+			fprintf(stderr, "Task %d created at tick %d while still running.\n", instruction->task_id, tick);
+			exit(1);
+		}
+		task = task_table_create(instruction->task_id);
+		task->burst_time = 0;
+		task->remaining_burst_time = 0;
+		task->current_queue = 0;
+		task->total_wait_time = 0;
+		task->total_execution_time = 0;
+		task->exit_pending = false;
+		task->next = NULL;
+		spawn_child(task);
+		output_new(&output, tick, task->id);
+		return;
+	}
+
+	if(task == NULL) {
+		fprintf(stderr, "Task %d used at tick %d before being created.\n", instruction->task_id, tick);
+		exit(1);
+	}
+
+	if(instruction->burst_time == -1) {
+		if(task->remaining_burst_time > 0) {
+			task->exit_pending = true;
+		} else {
+			report_exit(task, tick);
+		}
+	} else if(task->remaining_burst_time > 0) {
+		task->burst_time += instruction->burst_time;
+		task->remaining_burst_time += instruction->burst_time;
+	} else {
+		task->burst_time = instruction->burst_time;
+		task->remaining_burst_time = instruction->burst_time;
+		child_of(task)->burst_cpu_start = cpu_time(child_of(task)->pid);
+		if(task->current_queue == 0) {
+			task->current_queue = 1;
+		}
+		enqueue_task(task, ENQUEUE_WAKEUP, tick);
+	}
+}
+
+
+
+/*
+ * Function: schedule
+ * ------------------
+ *  Boosts on every multiple of the boost interval, then lets the MLFQ
+ *  pick or preempt the current task, as feedbackq's `boost()` and
+ *  `scheduler()` do.
+ */
+void schedule(int tick) {
+	if(tick % sched_config.boost_interval == 0) {
+		if(sched_class->boost(rq, current_task)) {
+			current_task->enqueued_at = tick;
+			num_queued++;
+			current_task = NULL;
+		}
+		output_boost(&output, tick, 0);
+	}
+
+	if(num_queued == 0) {
+		return;
+	}
+	if(current_task == NULL) {
+		current_task = pick_next_task(tick);
+	} else if(sched_class->preempt_check(rq, current_task)) {
+		enqueue_task(current_task, ENQUEUE_PREEMPTED, tick);
+		current_task = pick_next_task(tick);
+	}
+}
+
+
+
+/*
+ * Function: wait_tick
+ * -------------------
+ *  Blocks until the timer marks the end of the tick.
+ */
+void wait_tick(int timer) {
+	uint64_t expirations;
+
+	while(read(timer, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+		if(errno != EINTR) {
+			perror("timerfd");
+			exit(1);
+		}
+	}
+	overruns += expirations - 1;
+}
+
+
+
+/*
+ * Function: read_instruction
+ * --------------------------
+ *  Reads the next instruction of the case file, exiting on a line that
+ *  is not one.
+ */
+void read_instruction(Case_file_t *file, Instruction_t *instruction) {
+	int values[3];
+	int vars_read = case_next_line(file, values, 3);
+
+	instruction->is_eof = vars_read == EOF;
+	if(instruction->is_eof) {
+		return;
+	}
+	if(vars_read != 3) {
+		fprintf(stderr, "Error reading from the file.\n");
+		exit(1);
+	}
+	instruction->event_tick = values[0];
+	instruction->task_id = values[1];
+	instruction->burst_time = values[2];
+	if(instruction->event_tick < 0 || instruction->task_id < 0) {
+		fprintf(stderr, "Incorrect file input.\n");
+		exit(1);
+	}
+	if(instruction->burst_time < -1) {
+		fprintf(stderr, "I/O requests are not supported by mlfqrun.\n");
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: validate_args
+ * -----------------------
+ *  Sets the options from the command line args and returns the case
+ *  file.
+ */
+char *validate_args(int argc, char *argv[]) {
+	char *case_file = NULL;
+
+	for(int i = 1; i < argc; i++) {
+		if(strncmp(argv[i], "--tick=", 7) == 0) {
+			tick_ms = atoi(argv[i] + 7);
+			if(tick_ms < 1) {
+				fprintf(stderr, "Tick length must be positive\n");
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--core=", 7) == 0) {
+			core = atoi(argv[i] + 7);
+			if(core < 0 || core >= CPU_SETSIZE) {
+				fprintf(stderr, "Invalid core \"%s\"\n", argv[i] + 7);
+				exit(1);
+			}
+		} else if(strncmp(argv[i], "--", 2) == 0 || case_file != NULL) {
+			fprintf(stderr, "usage: mlfqrun [--tick=ms] [--core=n] <input_test_case_file>\n");
+			exit(1);
+		} else {
+			case_file = argv[i];
+		}
+	}
+	if(case_file == NULL) {
+		fprintf(stderr, "usage: mlfqrun [--tick=ms] [--core=n] <input_test_case_file>\n");
+		exit(1);
+	}
+	return case_file;
+}
+
+
+
+/*
+ * Function: main
+ * --------------
+ */
+int main(int argc, char *argv[]) {
+	char *case_file = validate_args(argc, argv);
+	struct itimerspec period = { { 0, 0 }, { 0, 0 } };
+	Instruction_t instruction;
+	Case_file_t file;
+	int timer, tick = 1;
+
+	if(!case_open(&file, case_file)) {
+		fprintf(stderr, "File \"%s\" does not exist.\n", case_file);
+		exit(1);
+	}
+	read_instruction(&file, &instruction);
+	if(instruction.is_eof) {
+		fprintf(stderr, "Error reading from the file. The file is empty.\n");
+		exit(1);
+	}
+
+	clock_ticks_per_second = sysconf(_SC_CLK_TCK);
+	rq = sched_class->create(&sched_config);
+	task_table_init();
+	output_init(&output, OUTPUT_TEXT, false, false);
+
+	timer = timerfd_create(CLOCK_MONOTONIC, 0);
+	period.it_interval.tv_sec = tick_ms / 1000;
+	period.it_interval.tv_nsec = (tick_ms % 1000) * 1000000L;
+	period.it_value = period.it_interval;
+	if(timer < 0 || timerfd_settime(timer, 0, &period, NULL) != 0) {
+		perror("timerfd");
+		exit(1);
+	}
+
+	while(true) {
+		int used = 0;
+
+		while(!instruction.is_eof && instruction.event_tick == tick) {
+			handle_instruction(&instruction, tick);
+			read_instruction(&file, &instruction);
+		}
+
+		schedule(tick);
+		dispatch();
+		if(current_task != NULL) {
+			used = current_task->burst_time - current_task->remaining_burst_time;
+		}
+
+		wait_tick(timer);
+		output_run(&output, 0, tick, 1, current_task, used);
+
+		if(current_task != NULL) {
+			Task_t *task = current_task;
+			bool expired = sched_class->tick(rq, task, 1);
+			int progress = burst_progress(task);
+
+			scheduled_ticks++;
+			task->total_execution_time++;
+			task->remaining_burst_time = progress >= task->burst_time ? 0 : task->burst_time - progress;
+
+			if(task->remaining_burst_time == 0) {
+				stop_child(task);
+				running_task = NULL;
+				current_task = NULL;
+				sched_class->dequeue(rq, task, DEQUEUE_SLEEP);
+				if(task->exit_pending) {
+					report_exit(task, tick + 1);
+				}
+			} else if(expired) {
+				// Left running until the next decision, which may keep it
+				enqueue_task(task, ENQUEUE_EXPIRED, tick + 1);
+				current_task = NULL;
+			}
+		}
+		output_flush(&output);
+
+		if(instruction.is_eof && current_task == NULL && num_queued == 0) {
+			break;
+		}
+		tick++;
+	}
+
+	output_finish(&output, tick);
+	fprintf(stderr, "ticks=%d scheduled=%ld cpu=%.2f overruns=%ld\n", tick, scheduled_ticks,
+		(double)cpu_clock_ticks * 1000 / clock_ticks_per_second / tick_ms, overruns);
+
+	case_close(&file);
+	sched_class->destroy(rq);
+	task_table_free();
+	return 0;
+}
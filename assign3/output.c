@@ -0,0 +1,318 @@
+/*
+ * output.c
+ *
+ * The simulator's output. Text goes through one large buffer written
+ * out with write(2), and numbers are formatted by hand, which for the
+ * per-tick lines is several times faster than printf(). The format of
+ * every line is that of the original printf() calls.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "output.h"
+
+static Output_t *stdout_owner = NULL;      // Flushed at exit
+
+
+static void flush_at_exit(void) {
+    if (stdout_owner != NULL) {
+        output_flush(stdout_owner);
+    }
+}
+
+
+static void reserve(Output_t *out, int n) {
+    if (out->used + n > OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+}
+
+
+static void put_str(Output_t *out, const char *s) {
+    while (*s != '\0') {
+        out->buffer[out->used++] = *s++;
+    }
+}
+
+
+/*
+ * Append `n` in decimal, zero-padded to at least `width` digits (as
+ * printf's "%0<width>d").
+ */
+static void put_int(Output_t *out, long n, int width) {
+    char digits[24];
+    int len = 0;
+    unsigned long u = n < 0 ? -(unsigned long)n : (unsigned long)n;
+
+    do {
+        digits[len++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+
+    if (n < 0) {
+        out->buffer[out->used++] = '-';
+        width--;
+    }
+    for (; width > len; width--) {
+        out->buffer[out->used++] = '0';
+    }
+    while (len > 0) {
+        out->buffer[out->used++] = digits[--len];
+    }
+}
+
+
+/*
+ * Append "[tick] " or "[tick-last] ", and "cpu=NN " if CPUs are named.
+ */
+static void put_prefix(Output_t *out, int tick, int span, int cpu) {
+    out->buffer[out->used++] = '[';
+    put_int(out, tick, 5);
+    if (span > 1) {
+        out->buffer[out->used++] = '-';
+        put_int(out, tick + span - 1, 5);
+    }
+    put_str(out, "] ");
+    if (out->cpu_labels && cpu >= 0) {
+        put_str(out, "cpu=");
+        put_int(out, cpu, 2);
+        out->buffer[out->used++] = ' ';
+    }
+}
+
+
+static void put_record(Output_t *out, int type, int tick, int span, int cpu,
+    int task_id, int arg1, int arg2, int queue)
+{
+    Event_record_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.tick = tick;
+    record.span = span;
+    record.cpu = cpu < 0 ? 0 : cpu;
+    record.task_id = task_id;
+    record.arg1 = arg1;
+    record.arg2 = arg2;
+    record.queue = queue;
+
+    reserve(out, sizeof(record));
+    memcpy(out->buffer + out->used, &record, sizeof(record));
+    out->used += sizeof(record);
+}
+
+
+/*
+ * Set up output in the given mode. The buffer is flushed when the 
+ * program exits, and before output_error() prints its message.
+ */
+void output_init(Output_t *out, int mode, bool compress, bool cpu_labels) {
+    memset(out, 0, sizeof(Output_t));
+    out->mode = mode;
+    out->compress = compress;
+    out->cpu_labels = cpu_labels;
+    if (mode == OUTPUT_NONE) {
+        return;
+    }
+    out->buffer = emalloc(OUTPUT_BUFFER_SIZE);
+
+    if (stdout_owner == NULL) {
+        atexit(flush_at_exit);
+    }
+    stdout_owner = out;
+
+    if (mode == OUTPUT_BINARY) {
+        memcpy(out->buffer, EVENT_MAGIC, strlen(EVENT_MAGIC));
+        out->used = strlen(EVENT_MAGIC);
+    }
+}
+
+
+/*
+ * Print an error message to stderr and exit. Buffered output is written
+ * out first, so that the message follows the output printed before it.
+ */
+void output_error(const char *format, ...) {
+    va_list args;
+
+    flush_at_exit();
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    exit(1);
+}
+
+
+/*
+ * Write out everything buffered so far.
+ */
+void output_flush(Output_t *out) {
+    int done = 0;
+
+    if (out->buffer == NULL) {
+        return;
+    }
+    fflush(stdout);
+    while (done < out->used) {
+        ssize_t n = write(STDOUT_FILENO, out->buffer + done, out->used - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            perror("write");
+            out->used = 0;
+            exit(1);
+        }
+        done += n;
+    }
+    out->used = 0;
+}
+
+
+/*
+ * End the output of a simulation that ended at `tick`: in summary mode
+ * print the totals, then flush and free the buffer.
+ */
+void output_finish(Output_t *out, int tick) {
+    if (out->mode == OUTPUT_SUMMARY) {
+        output_flush(out);
+        printf("exits=%ld wt_mean=%.2f tat_mean=%.2f wt_max=%d tat_max=%d ticks=%d\n",
+            out->exits,
+            out->exits > 0 ? (double)out->total_wait / out->exits : 0.0,
+            out->exits > 0 ? (double)out->total_turnaround / out->exits : 0.0,
+            out->max_wait, out->max_turnaround, tick);
+    }
+    output_flush(out);
+    free(out->buffer);
+    out->buffer = NULL;
+    if (stdout_owner == out) {
+        stdout_owner = NULL;
+    }
+}
+
+
+void output_new(Output_t *out, int tick, int task_id) {
+    switch (out->mode) {
+    case OUTPUT_TEXT:
+        reserve(out, 64);
+        put_prefix(out, tick, 1, -1);
+        put_str(out, "id=");
+        put_int(out, task_id, 4);
+        put_str(out, " NEW\n");
+        break;
+    case OUTPUT_BINARY:
+        put_record(out, EVENT_NEW, tick, 1, 0, task_id, 0, 0, 0);
+        break;
+    }
+}
+
+
+/*
+ * What a CPU does over `span` ticks from `tick`: run `task` (which has
+ * used `used` ticks of its burst before `tick`), or idle if it is NULL.
+ * As text this is one line, so in the per-tick format `span` must be 1.
+ */
+void output_run(Output_t *out, int cpu, int tick, int span, Task_t *task, int used) {
+    switch (out->mode) {
+    case OUTPUT_TEXT:
+        reserve(out, 160);
+        put_prefix(out, tick, span, cpu);
+        if (task == NULL) {
+            put_str(out, "IDLE\n");
+            break;
+        }
+        put_str(out, "id=");
+        put_int(out, task->id, 4);
+        put_str(out, " req=");
+        put_int(out, task->burst_time, 0);
+        put_str(out, " used=");
+        put_int(out, used + 1, 0);
+        if (span > 1) {
+            out->buffer[out->used++] = '-';
+            put_int(out, used + span, 0);
+        }
+        put_str(out, " queue=");
+        put_int(out, task->current_queue, 0);
+        out->buffer[out->used++] = '\n';
+        break;
+    case OUTPUT_BINARY:
+        if (task == NULL) {
+            put_record(out, EVENT_IDLE, tick, span, cpu, 0, 0, 0, 0);
+        } else {
+            put_record(out, EVENT_RUN, tick, span, cpu, task->id, task->burst_time,
+                used, task->current_queue);
+        }
+        break;
+    }
+}
+
+
+/*
+ * A boost of the given CPU's queues (-1 if there is only one CPU).
+ */
+void output_boost(Output_t *out, int tick, int cpu) {
+    switch (out->mode) {
+    case OUTPUT_TEXT:
+        reserve(out, 64);
+        put_prefix(out, tick, 1, cpu);
+        put_str(out, "BOOST\n");
+        break;
+    case OUTPUT_BINARY:
+        put_record(out, EVENT_BOOST, tick, 1, cpu, 0, 0, 0, 0);
+        break;
+    }
+}
+
+
+/*
+ * A boost of one task (--adaptive-boost) on the given CPU's queues.
+ */
+void output_boost_task(Output_t *out, int tick, int cpu, int task_id) {
+    switch (out->mode) {
+    case OUTPUT_TEXT:
+        reserve(out, 64);
+        put_prefix(out, tick, 1, cpu);
+        put_str(out, "id=");
+        put_int(out, task_id, 4);
+        put_str(out, " BOOST\n");
+        break;
+    case OUTPUT_BINARY:
+        put_record(out, EVENT_BOOST, tick, 1, cpu, task_id, 0, 0, 0);
+        break;
+    }
+}
+
+
+void output_exit(Output_t *out, int tick, int task_id, int wait, int turnaround) {
+    out->exits++;
+    out->total_wait += wait;
+    out->total_turnaround += turnaround;
+    if (wait > out->max_wait) {
+        out->max_wait = wait;
+    }
+    if (turnaround > out->max_turnaround) {
+        out->max_turnaround = turnaround;
+    }
+
+    switch (out->mode) {
+    case OUTPUT_TEXT:
+    case OUTPUT_SUMMARY:
+        reserve(out, 96);
+        put_prefix(out, tick, 1, -1);
+        put_str(out, "id=");
+        put_int(out, task_id, 4);
+        put_str(out, " EXIT wt=");
+        put_int(out, wait, 0);
+        put_str(out, " tat=");
+        put_int(out, turnaround, 0);
+        out->buffer[out->used++] = '\n';
+        break;
+    case OUTPUT_BINARY:
+        put_record(out, EVENT_EXIT, tick, 1, 0, task_id, wait, turnaround, 0);
+        break;
+    }
+}
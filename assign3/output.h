@@ -0,0 +1,73 @@
+#ifndef _OUTPUT_H_
+#define _OUTPUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "queue.h"
+
+/*
+ * What the simulator writes to standard output:
+ *   OUTPUT_TEXT     the per-tick text, through a large buffer
+ *   OUTPUT_BINARY   a log of fixed-size Event_record_t records
+ *   OUTPUT_SUMMARY  one line per task exit and the totals
+ *   OUTPUT_NONE     nothing; only the totals are kept
+ */
+#define OUTPUT_TEXT     0
+#define OUTPUT_BINARY   1
+#define OUTPUT_SUMMARY  2
+#define OUTPUT_NONE     3
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+/*
+ * The binary log starts with the 8 bytes "FQEVENT1" and is followed by
+ * records in the order the text lines would be printed, in host byte
+ * order. A RUN or IDLE record covers `span` ticks from `tick`, however
+ * --compress is set.
+ */
+#define EVENT_NEW   1           // task_id
+#define EVENT_RUN   2           // task_id, arg1 = req, arg2 = used before tick, queue
+#define EVENT_IDLE  3
+#define EVENT_BOOST 4           // task_id of a single task's boost, or 0
+#define EVENT_EXIT  5           // task_id, arg1 = wt, arg2 = tat
+
+#define EVENT_MAGIC "FQEVENT1"
+
+typedef struct Event_record Event_record_t;
+struct Event_record {
+    int32_t     tick;
+    int32_t     span;
+    int32_t     task_id;
+    int32_t     arg1;
+    int32_t     arg2;
+    uint8_t     type;
+    uint8_t     cpu;
+    int16_t     queue;
+};
+
+typedef struct Output Output_t;
+struct Output {
+    int         mode;
+    bool        compress;       // Text: print runs of ticks as ranges
+    bool        cpu_labels;     // Text: name the CPU on per-tick and BOOST lines
+    char        *buffer;
+    int         used;
+
+    long        exits;          // Summary totals
+    long long   total_wait;
+    long long   total_turnaround;
+    int         max_wait;
+    int         max_turnaround;
+};
+
+void output_init(Output_t *, int mode, bool compress, bool cpu_labels);
+void output_flush(Output_t *);
+void output_error(const char *format, ...) __attribute__((format(printf, 1, 2), noreturn));
+void output_finish(Output_t *, int tick);
+void output_new(Output_t *, int tick, int task_id);
+void output_run(Output_t *, int cpu, int tick, int span, Task_t *task, int used);
+void output_boost(Output_t *, int tick, int cpu);
+void output_boost_task(Output_t *, int tick, int cpu, int task_id);
+void output_exit(Output_t *, int tick, int task_id, int wait, int turnaround);
+
+#endif
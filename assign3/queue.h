@@ -1,16 +1,51 @@
 #ifndef _QUEUE_H_
 #define _QUEUE_H_
 
+#include <stddef.h>
+#include "rbtree.h"
+
 typedef struct Task Task_t;
 struct Task {
     int         id;
+    int         slot;                   // Slot in the task table
     int         burst_time;
     int         remaining_burst_time;
-    int         current_queue;
 
     int         total_wait_time;        // For Computing `Wait Time`
     int         total_execution_time;   // For Computing `Turn Around Time`
+    int         enqueued_at;            // First tick counted as waiting while queued
+    short       current_queue;
+    unsigned char cpu;                  // CPU whose queues the task joins
+    unsigned char exit_pending;         // EXIT seen before the burst completed
     Task_t      *next;                  // For Queue (Linked List) Operations
+
+    // Current burst, for the latency histograms (--histograms)
+    int         burst_arrived_at;       // Tick the burst arrived
+    int         burst_started_at;       // Tick it first ran, or -1
+    int         burst_wait_base;        // `total_wait_time` when it arrived
+
+    // I/O request (see "Devices" in feedbackq.c)
+    int         io_device;              // Device requested, or -1 if none
+    int         io_service_time;
+    int         io_held_burst;          // CPU time of bursts arriving meanwhile
+
+    // Real-time server (see "Real-time tasks" in feedbackq.c)
+    int         rt_runtime;             // Budget per period, or 0 if not real-time
+    int         rt_period;
+    int         rt_deadline;            // Relative deadline of each job
+    int         rt_budget;              // Budget left until replenished
+    int         rt_server_deadline;     // Absolute deadline EDF orders by
+    int         rt_throttled_until;     // Tick the budget is replenished, or -1
+    int         rt_job_release;         // Tick the current job was released
+    int         rt_next_release;        // Next job of a periodic task, or -1
+
+    // Scheduling policy state (see sched.h)
+    long long   vruntime;               // Virtual runtime (CFS, EEVDF) or pass (stride)
+    long long   deadline;               // Virtual deadline (EEVDF)
+    long long   min_vruntime;           // Least vruntime in the run_node subtree (EEVDF)
+    int         level;                  // Queue the task waits in (MLFQ)
+    unsigned    boost_epoch;            // Boosts of that run queue when it was queued (MLFQ)
+    Rb_node_t   run_node;               // Run queue tree links
 };
 
 typedef struct Instruction Instruction_t;
@@ -18,6 +53,11 @@ struct Instruction {
     int         event_tick;
     int         task_id;
     int         burst_time;
+    int         device;                 // For I/O requests (burst_time == -2)
+    int         service_time;
+    int         runtime;                // For real-time tasks (burst_time == -3 or -4)
+    int         period;
+    int         deadline;
     int         is_eof;
 };
 
@@ -34,6 +74,7 @@ void enqueue(Queue_t *, Task_t *);
 Task_t *dequeue(Queue_t *);
 int queue_size(Queue_t *);
 
+void *emalloc(size_t);
 void deallocate(void *);
 
 #endif
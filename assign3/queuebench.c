@@ -0,0 +1,284 @@
+/*
+ * queuebench.c
+ *
+ * Benchmark of the chunked run queue (ring_queue.c) against the
+ * linked list Queue_t (queue.c).
+ * --------------------
+ * 	1) Churn: n tasks go round a queue m times, popping the front and
+ * 	   pushing it back, as round-robin scheduling does.
+ * 	2) Size: the length of an n-task queue is taken m times.
+ * 	3) Boost: n tasks spread over levels 2 to l are moved to level 1;
+ * 	   m times. The list relabels and moves each task, while the
+ * 	   chunked queue is spliced whole, as sched_mlfq's boost does
+ * 	   (which relabels a task only when it is popped).
+ * 	The tasks are allocated in one array but queued in a random order,
+ * 	as they are in feedbackq once tasks come and go.
+ *
+ * Input: Command Line args
+ * ------------------------
+ * 	./queuebench [--tasks=n] [--rounds=m] [--levels=l] [--seed=s]
+ *
+ * 	--tasks=<n>   Number of tasks (default 10000).
+ * 	--rounds=<m>  Repetitions of each benchmark (default 100).
+ * 	--levels=<l>  Queue levels in the boost benchmark (default 8).
+ * 	--seed=<s>    Seed of the random queue order (default 1).
+ *
+ * Output:
+ * -----------------------
+ * 	One line per benchmark and queue, with the time per task moved
+ * 	(or per call, for the size).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "queue.h"
+#include "ring_queue.h"
+
+#define MAX_BENCH_LEVELS 64
+
+
+int num_tasks = 10000;
+int num_rounds = 100;
+int num_levels = 8;
+unsigned seed = 1;
+
+Task_t *tasks;
+Task_t **order;					// The tasks in queueing order
+
+volatile long sink;				// Keeps results the compiler could drop
+
+
+/*
+ * Function: now
+ * -------------
+ *  Returns the monotonic clock in seconds.
+ */
+double now() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+
+/*
+ * Function: shuffle_tasks
+ * -----------------------
+ *  Fills `order` with the tasks in a random order (Fisher-Yates).
+ */
+void shuffle_tasks() {
+	srand(seed);
+	for(int i = 0; i < num_tasks; i++) {
+		order[i] = &tasks[i];
+	}
+	for(int i = num_tasks - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		Task_t *swap = order[i];
+
+		order[i] = order[j];
+		order[j] = swap;
+	}
+}
+
+
+
+void print_result(const char *bench, const char *queue, double elapsed, double ops) {
+	printf("%-6s %-6s tasks=%d rounds=%d ns_per_op=%.2f\n",
+		bench, queue, num_tasks, num_rounds, elapsed * 1e9 / ops);
+}
+
+
+
+/*
+ * Function: bench_churn
+ * ---------------------
+ */
+void bench_churn() {
+	double ops = (double)num_tasks * num_rounds;
+	Queue_t *list = init_queue();
+	Ring_queue_t ring;
+	double start;
+
+	for(int i = 0; i < num_tasks; i++) {
+		enqueue(list, order[i]);
+	}
+	start = now();
+	for(long i = 0; i < (long)num_tasks * num_rounds; i++) {
+		Task_t *task = dequeue(list);
+
+		task->remaining_burst_time--;
+		enqueue(list, task);
+	}
+	print_result("churn", "list", now() - start, ops);
+	while(dequeue(list) != NULL)
+		;
+	deallocate(list);
+
+	ring_init(&ring);
+	for(int i = 0; i < num_tasks; i++) {
+		ring_push(&ring, order[i]);
+	}
+	start = now();
+	for(long i = 0; i < (long)num_tasks * num_rounds; i++) {
+		Task_t *task = ring_pop(&ring);
+
+		task->remaining_burst_time--;
+		ring_push(&ring, task);
+	}
+	print_result("churn", "ring", now() - start, ops);
+	ring_free(&ring);
+}
+
+
+
+/*
+ * Function: bench_size
+ * --------------------
+ */
+void bench_size() {
+	Queue_t *list = init_queue();
+	Ring_queue_t ring;
+	double start;
+
+	ring_init(&ring);
+	for(int i = 0; i < num_tasks; i++) {
+		enqueue(list, order[i]);
+		ring_push(&ring, order[i]);
+	}
+
+	start = now();
+	for(int r = 0; r < num_rounds; r++) {
+		sink += queue_size(list);
+	}
+	print_result("size", "list", now() - start, num_rounds);
+
+	start = now();
+	for(int r = 0; r < num_rounds; r++) {
+		sink += ring_size(&ring);
+	}
+	print_result("size", "ring", now() - start, num_rounds);
+
+	while(dequeue(list) != NULL)
+		;
+	deallocate(list);
+	ring_free(&ring);
+}
+
+
+
+/*
+ * Function: bench_boost
+ * ---------------------
+ *  Times only the boosts; spreading the tasks back over the levels
+ *  between them is not counted.
+ */
+void bench_boost() {
+	double ops = (double)num_tasks * num_rounds;
+	Queue_t *lists[MAX_BENCH_LEVELS];
+	Ring_queue_t rings[MAX_BENCH_LEVELS];
+	double elapsed = 0;
+
+	for(int level = 0; level < num_levels; level++) {
+		lists[level] = init_queue();
+		ring_init(&rings[level]);
+	}
+
+	for(int r = 0; r < num_rounds; r++) {
+		double start;
+		Task_t *task;
+
+		for(int i = 0; i < num_tasks; i++) {
+			enqueue(lists[1 + i % (num_levels - 1)], order[i]);
+		}
+		start = now();
+		for(int level = num_levels - 1; level > 0; level--) {
+			while((task = dequeue(lists[level])) != NULL) {
+				task->current_queue = 1;
+				task->level = 1;
+				enqueue(lists[0], task);
+			}
+		}
+		elapsed += now() - start;
+		while(dequeue(lists[0]) != NULL)
+			;
+	}
+	print_result("boost", "list", elapsed, ops);
+
+	elapsed = 0;
+	for(int r = 0; r < num_rounds; r++) {
+		double start;
+
+		for(int i = 0; i < num_tasks; i++) {
+			ring_push(&rings[1 + i % (num_levels - 1)], order[i]);
+		}
+		start = now();
+		for(int level = num_levels - 1; level > 0; level--) {
+			ring_splice(&rings[0], &rings[level]);
+		}
+		elapsed += now() - start;
+		while(ring_pop(&rings[0]) != NULL)
+			;
+	}
+	print_result("boost", "ring", elapsed, ops);
+
+	for(int level = 0; level < num_levels; level++) {
+		deallocate(lists[level]);
+		ring_free(&rings[level]);
+	}
+}
+
+
+
+/*
+ * Function: validate_args
+ * -----------------------
+ */
+void validate_args(int argc, char *argv[]) {
+	for(int i = 1; i < argc; i++) {
+		if(strncmp(argv[i], "--tasks=", 8) == 0) {
+			num_tasks = atoi(argv[i] + 8);
+		} else if(strncmp(argv[i], "--rounds=", 9) == 0) {
+			num_rounds = atoi(argv[i] + 9);
+		} else if(strncmp(argv[i], "--levels=", 9) == 0) {
+			num_levels = atoi(argv[i] + 9);
+		} else if(strncmp(argv[i], "--seed=", 7) == 0) {
+			seed = strtoul(argv[i] + 7, NULL, 10);
+		} else {
+			fprintf(stderr, "usage: queuebench [--tasks=n] [--rounds=m] [--levels=l] [--seed=s]\n");
+			exit(1);
+		}
+	}
+	if(num_tasks < 1 || num_rounds < 1 || num_levels < 2 || num_levels > MAX_BENCH_LEVELS) {
+		fprintf(stderr, "Invalid argument\n");
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: main
+ * --------------
+ */
+int main(int argc, char *argv[]) {
+	validate_args(argc, argv);
+	tasks = calloc(num_tasks, sizeof(Task_t));
+	order = malloc(num_tasks * sizeof(Task_t *));
+	if(tasks == NULL || order == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(1);
+	}
+	shuffle_tasks();
+
+	bench_churn();
+	bench_size();
+	bench_boost();
+
+	free(order);
+	free(tasks);
+	return 0;
+}
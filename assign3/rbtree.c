@@ -0,0 +1,301 @@
+/*
+ * rbtree.c
+ *
+ * Red-black tree following the presentation in "Introduction to
+ * Algorithms" by Cormen, Leiserson, Rivest and Stein (3rd ed., MIT
+ * Press, 2009), chapter 13, with NULL in place of the sentinel leaf.
+ */
+
+#include <stdio.h>
+#include "rbtree.h"
+
+
+/*
+ * Recompute the summaries of the node and all of its ancestors.
+ */
+static void augment_path(Rb_tree_t *tree, Rb_node_t *node) {
+    if (tree->augment == NULL) {
+        return;
+    }
+    for (; node != NULL; node = node->parent) {
+        tree->augment(node);
+    }
+}
+
+
+/*
+ * Make `new` take the place of `old` as a child of old's parent.
+ */
+static void replace_child(Rb_tree_t *tree, Rb_node_t *old, Rb_node_t *new) {
+    Rb_node_t *parent = old->parent;
+
+    if (parent == NULL) {
+        tree->root = new;
+    } else if (parent->left == old) {
+        parent->left = new;
+    } else {
+        parent->right = new;
+    }
+    if (new != NULL) {
+        new->parent = parent;
+    }
+}
+
+
+static void rotate_left(Rb_tree_t *tree, Rb_node_t *x) {
+    Rb_node_t *y = x->right;
+
+    x->right = y->left;
+    if (y->left != NULL) {
+        y->left->parent = x;
+    }
+    replace_child(tree, x, y);
+    y->left = x;
+    x->parent = y;
+
+    if (tree->augment != NULL) {
+        tree->augment(x);
+        tree->augment(y);
+    }
+}
+
+
+static void rotate_right(Rb_tree_t *tree, Rb_node_t *x) {
+    Rb_node_t *y = x->left;
+
+    x->left = y->right;
+    if (y->right != NULL) {
+        y->right->parent = x;
+    }
+    replace_child(tree, x, y);
+    y->right = x;
+    x->parent = y;
+
+    if (tree->augment != NULL) {
+        tree->augment(x);
+        tree->augment(y);
+    }
+}
+
+
+static int is_red(Rb_node_t *node) {
+    return node != NULL && node->red;
+}
+
+
+/*
+ * Initialize an empty tree ordered by `less`, with an optional
+ * `augment` callback (NULL for none).
+ */
+void rb_init(Rb_tree_t *tree, int (*less)(const Rb_node_t *, const Rb_node_t *),
+    void (*augment)(Rb_node_t *))
+{
+    tree->root = NULL;
+    tree->leftmost = NULL;
+    tree->count = 0;
+    tree->less = less;
+    tree->augment = augment;
+}
+
+
+/*
+ * Insert the node after any nodes that compare equal to it.
+ */
+void rb_insert(Rb_tree_t *tree, Rb_node_t *node) {
+    Rb_node_t *parent = NULL;
+    Rb_node_t **link = &tree->root;
+    int leftmost = 1;
+
+    while (*link != NULL) {
+        parent = *link;
+        if (tree->less(node, parent)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            leftmost = 0;
+        }
+    }
+
+    node->parent = parent;
+    node->left = node->right = NULL;
+    node->red = 1;
+    *link = node;
+    if (leftmost) {
+        tree->leftmost = node;
+    }
+    tree->count++;
+    augment_path(tree, node);
+
+    // Restore the red-black properties (CLRS RB-INSERT-FIXUP)
+    while (is_red(node->parent)) {
+        Rb_node_t *p = node->parent;
+        Rb_node_t *g = p->parent;
+
+        if (p == g->left) {
+            Rb_node_t *uncle = g->right;
+            if (is_red(uncle)) {
+                p->red = uncle->red = 0;
+                g->red = 1;
+                node = g;
+                continue;
+            }
+            if (node == p->right) {
+                rotate_left(tree, p);
+                node = p;
+                p = node->parent;
+            }
+            p->red = 0;
+            g->red = 1;
+            rotate_right(tree, g);
+        } else {
+            Rb_node_t *uncle = g->left;
+            if (is_red(uncle)) {
+                p->red = uncle->red = 0;
+                g->red = 1;
+                node = g;
+                continue;
+            }
+            if (node == p->left) {
+                rotate_right(tree, p);
+                node = p;
+                p = node->parent;
+            }
+            p->red = 0;
+            g->red = 1;
+            rotate_left(tree, g);
+        }
+    }
+    tree->root->red = 0;
+}
+
+
+/*
+ * Remove the node from the tree.
+ */
+void rb_erase(Rb_tree_t *tree, Rb_node_t *node) {
+    Rb_node_t *child, *parent;
+    int removed_red;
+
+    if (tree->leftmost == node) {
+        tree->leftmost = rb_next(node);
+    }
+    tree->count--;
+
+    if (node->left == NULL || node->right == NULL) {
+        child = node->left != NULL ? node->left : node->right;
+        parent = node->parent;
+        removed_red = node->red;
+        replace_child(tree, node, child);
+    } else {
+        // Splice out the successor and put it in the node's place
+        Rb_node_t *next = node->right;
+        while (next->left != NULL) {
+            next = next->left;
+        }
+        removed_red = next->red;
+        child = next->right;
+
+        if (next->parent == node) {
+            parent = next;
+        } else {
+            parent = next->parent;
+            replace_child(tree, next, child);
+            next->right = node->right;
+            next->right->parent = next;
+        }
+        replace_child(tree, node, next);
+        next->left = node->left;
+        next->left->parent = next;
+        next->red = node->red;
+    }
+    augment_path(tree, parent);
+
+    if (removed_red) {
+        return;
+    }
+
+    // Restore the red-black properties (CLRS RB-DELETE-FIXUP); `child`
+    // may be NULL, so its parent is tracked separately
+    while (child != tree->root && !is_red(child)) {
+        if (child == parent->left) {
+            Rb_node_t *sibling = parent->right;
+            if (is_red(sibling)) {
+                sibling->red = 0;
+                parent->red = 1;
+                rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->red = 1;
+                child = parent;
+                parent = child->parent;
+                continue;
+            }
+            if (!is_red(sibling->right)) {
+                sibling->left->red = 0;
+                sibling->red = 1;
+                rotate_right(tree, sibling);
+                sibling = parent->right;
+            }
+            sibling->red = parent->red;
+            parent->red = 0;
+            sibling->right->red = 0;
+            rotate_left(tree, parent);
+            child = tree->root;
+        } else {
+            Rb_node_t *sibling = parent->left;
+            if (is_red(sibling)) {
+                sibling->red = 0;
+                parent->red = 1;
+                rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->red = 1;
+                child = parent;
+                parent = child->parent;
+                continue;
+            }
+            if (!is_red(sibling->left)) {
+                sibling->right->red = 0;
+                sibling->red = 1;
+                rotate_left(tree, sibling);
+                sibling = parent->left;
+            }
+            sibling->red = parent->red;
+            parent->red = 0;
+            sibling->left->red = 0;
+            rotate_right(tree, parent);
+            child = tree->root;
+        }
+    }
+    if (child != NULL) {
+        child->red = 0;
+    }
+}
+
+
+/*
+ * Return the first node in order, or NULL if the tree is empty.
+ */
+Rb_node_t *rb_first(const Rb_tree_t *tree) {
+    return tree->leftmost;
+}
+
+
+/*
+ * Return the node following the given one in order, or NULL.
+ */
+Rb_node_t *rb_next(const Rb_node_t *node) {
+    if (node->right != NULL) {
+        node = node->right;
+        while (node->left != NULL) {
+            node = node->left;
+        }
+        return (Rb_node_t *)node;
+    }
+    while (node->parent != NULL && node == node->parent->right) {
+        node = node->parent;
+    }
+    return node->parent;
+}
@@ -0,0 +1,43 @@
+#ifndef _RBTREE_H_
+#define _RBTREE_H_
+
+#include <stddef.h>
+
+/*
+ * Intrusive red-black tree: an Rb_node_t is embedded in the structure
+ * being ordered, and rb_entry() gets back from the node to that
+ * structure. Nodes comparing equal are kept in insertion order.
+ *
+ * If `augment` is given, it is called to recompute a node's summary of
+ * its subtree (e.g., a minimum over it) from the node and its
+ * children, and the tree keeps those summaries correct on every
+ * insertion, removal and rotation.
+ */
+typedef struct Rb_node Rb_node_t;
+struct Rb_node {
+    Rb_node_t   *parent;
+    Rb_node_t   *left;
+    Rb_node_t   *right;
+    int         red;
+};
+
+typedef struct Rb_tree Rb_tree_t;
+struct Rb_tree {
+    Rb_node_t   *root;
+    Rb_node_t   *leftmost;              // Cached first node
+    int         count;
+    int         (*less)(const Rb_node_t *, const Rb_node_t *);
+    void        (*augment)(Rb_node_t *);
+};
+
+#define rb_entry(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+void rb_init(Rb_tree_t *, int (*)(const Rb_node_t *, const Rb_node_t *),
+    void (*)(Rb_node_t *));
+void rb_insert(Rb_tree_t *, Rb_node_t *);
+void rb_erase(Rb_tree_t *, Rb_node_t *);
+Rb_node_t *rb_first(const Rb_tree_t *);
+Rb_node_t *rb_next(const Rb_node_t *);
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * ring_queue.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ring_queue.h"
+
+
+/*
+ * An empty chunk: the spare one if there is one, else a new one.
+ */
+static Ring_chunk_t *take_chunk(Ring_queue_t *q) {
+    Ring_chunk_t *chunk = q->spare;
+
+    if (chunk == NULL) {
+        chunk = emalloc(sizeof(Ring_chunk_t));
+    }
+    q->spare = NULL;
+    chunk->next = NULL;
+    chunk->begin = 0;
+    chunk->end = 0;
+    return chunk;
+}
+
+
+/*
+ * Keep a drained chunk as the spare, so that a queue whose length 
+ * hovers around a chunk boundary does not allocate on every push.
+ */
+static void drop_chunk(Ring_queue_t *q, Ring_chunk_t *chunk) {
+    if (q->spare == NULL) {
+        q->spare = chunk;
+    } else {
+        free(chunk);
+    }
+}
+
+
+/*
+ * Unlink the drained chunk that follows `prev` (or the front chunk, if
+ * `prev` is NULL).
+ */
+static void unlink_chunk(Ring_queue_t *q, Ring_chunk_t *prev, Ring_chunk_t *chunk) {
+    if (prev == NULL) {
+        q->front = chunk->next;
+    } else {
+        prev->next = chunk->next;
+    }
+    if (q->back == chunk) {
+        q->back = prev;
+    }
+    drop_chunk(q, chunk);
+}
+
+
+void ring_init(Ring_queue_t *q) {
+    memset(q, 0, sizeof(Ring_queue_t));
+}
+
+
+void ring_free(Ring_queue_t *q) {
+    Ring_chunk_t *chunk = q->front;
+
+    while (chunk != NULL) {
+        Ring_chunk_t *next = chunk->next;
+
+        free(chunk);
+        chunk = next;
+    }
+    free(q->spare);
+    ring_init(q);
+}
+
+
+unsigned ring_size(const Ring_queue_t *q) {
+    return q->count;
+}
+
+
+/*
+ * The task `index` places from the front (which is index 0). This 
+ * walks the chunks, so it is O(1) only near the front.
+ */
+Task_t *ring_at(const Ring_queue_t *q, unsigned index) {
+    Ring_chunk_t *chunk = q->front;
+
+    while (index >= chunk->end - chunk->begin) {
+        index -= chunk->end - chunk->begin;
+        chunk = chunk->next;
+    }
+    return chunk->tasks[chunk->begin + index];
+}
+
+
+void ring_push(Ring_queue_t *q, Task_t *task) {
+    if (q->back == NULL || q->back->end == RING_CHUNK_TASKS) {
+        Ring_chunk_t *chunk = take_chunk(q);
+
+        if (q->back == NULL) {
+            q->front = chunk;
+        } else {
+            q->back->next = chunk;
+        }
+        q->back = chunk;
+    }
+    q->back->tasks[q->back->end++] = task;
+    q->count++;
+}
+
+
+/*
+ * Remove and return the front task, or NULL if the queue is empty.
+ */
+Task_t *ring_pop(Ring_queue_t *q) {
+    Ring_chunk_t *chunk = q->front;
+    Task_t *task;
+
+    if (q->count == 0) {
+        return NULL;
+    }
+    task = chunk->tasks[chunk->begin++];
+    q->count--;
+    if (chunk->begin == chunk->end) {
+        unlink_chunk(q, NULL, chunk);
+    }
+    return task;
+}
+
+
+/*
+ * Remove the task from wherever it is in the queue; false if it is not
+ * there. Only the tasks behind it in its chunk are moved.
+ */
+bool ring_remove(Ring_queue_t *q, Task_t *task) {
+    Ring_chunk_t *prev = NULL;
+
+    for (Ring_chunk_t *chunk = q->front; chunk != NULL; prev = chunk, chunk = chunk->next) {
+        for (unsigned i = chunk->begin; i < chunk->end; i++) {
+            if (chunk->tasks[i] != task) {
+                continue;
+            }
+            memmove(&chunk->tasks[i], &chunk->tasks[i + 1], (chunk->end - i - 1) * sizeof(Task_t *));
+            chunk->end--;
+            q->count--;
+            if (chunk->begin == chunk->end) {
+                unlink_chunk(q, prev, chunk);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Append all of `from`, in order, to `to`, leaving `from` empty. This
+ * links the chunks of `from` after those of `to`, in O(1) whatever the
+ * number of tasks.
+ */
+void ring_splice(Ring_queue_t *to, Ring_queue_t *from) {
+    if (from->count == 0) {
+        return;
+    }
+    if (to->back == NULL) {
+        to->front = from->front;
+    } else {
+        to->back->next = from->front;
+    }
+    to->back = from->back;
+    to->count += from->count;
+    from->front = NULL;
+    from->back = NULL;
+    from->count = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef _RING_QUEUE_H_
+#define _RING_QUEUE_H_
+
+#include <stdbool.h>
+#include "queue.h"
+
+/*
+ * A FIFO of tasks in a linked list of fixed-size chunks, each a run of
+ * contiguous memory that is filled at the back and drained from the
+ * front. Unlike Queue_t it does not use `Task_t::next` and knows its
+ * size, and one queue can be appended to another in O(1), by linking
+ * its chunks. It holds task pointers rather than task table slots, so
+ * that tasks outside the table (see green.h) can be queued too.
+ */
+#define RING_CHUNK_TASKS 64
+
+typedef struct Ring_chunk Ring_chunk_t;
+struct Ring_chunk {
+    Ring_chunk_t *next;
+    unsigned    begin;          // Index of the chunk's front task
+    unsigned    end;            // One past its back task
+    Task_t      *tasks[RING_CHUNK_TASKS];
+};
+
+typedef struct Ring_queue Ring_queue_t;
+struct Ring_queue {
+    Ring_chunk_t *front;        // NULL while the queue is empty
+    Ring_chunk_t *back;
+    Ring_chunk_t *spare;        // Drained chunk kept for the next push
+    unsigned    count;
+};
+
+void ring_init(Ring_queue_t *);
+void ring_free(Ring_queue_t *);
+unsigned ring_size(const Ring_queue_t *);
+Task_t *ring_at(const Ring_queue_t *, unsigned index);
+void ring_push(Ring_queue_t *, Task_t *);
+Task_t *ring_pop(Ring_queue_t *);
+bool ring_remove(Ring_queue_t *, Task_t *);
+void ring_splice(Ring_queue_t *to, Ring_queue_t *from);
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include <stdbool.h>
+#include "queue.h"
+
+#define MAX_LEVELS 64
+
+/*
+ * Why a task is added to a run queue:
+ *   ENQUEUE_WAKEUP     a new burst arrived
+ *   ENQUEUE_PREEMPTED  the running task was preempted (or boosted)
+ *   ENQUEUE_EXPIRED    the running task used up its time slice
+ *   ENQUEUE_MIGRATED   a waiting task was moved here from another CPU
+ *
+ * and why one leaves it:
+ *   DEQUEUE_SLEEP      the running task finished its burst
+ *   DEQUEUE_MIGRATE    a waiting task is being moved to another CPU
+ */
+#define ENQUEUE_WAKEUP      0
+#define ENQUEUE_PREEMPTED   1
+#define ENQUEUE_EXPIRED     2
+#define ENQUEUE_MIGRATED    3
+
+#define DEQUEUE_SLEEP       0
+#define DEQUEUE_MIGRATE     1
+
+
+/*
+ * Tunables of all the policies. Each policy reads the ones it needs.
+ */
+typedef struct Sched_config Sched_config_t;
+struct Sched_config {
+    int     num_levels;                 // MLFQ: number of queues
+    int     time_quantums[MAX_LEVELS];  // MLFQ: quantum of each queue
+    int     demote_step;                // MLFQ: levels dropped on using up a quantum
+    int     boost_interval;             // MLFQ: ticks between boosts
+    int     boost_target;               // MLFQ: wait that triggers an adaptive boost, or 0
+    int     slice;                      // EEVDF: request size, stride: quantum
+    int     latency;                    // CFS: period in which every task runs once
+    int     granularity;                // CFS: minimum slice, and wakeup preemption margin
+};
+
+
+/*
+ * A scheduling policy, driving one run queue per CPU. The simulator
+ * owns the task that is running; a policy only sees it when it is 
+ * picked, charged for ticks, and put back or finished:
+ *
+ *   create, destroy  make and free a run queue using the given config
+ *   enqueue          add a task to the run queue (an ENQUEUE_* reason)
+ *   dequeue          a task leaves the run queue (a DEQUEUE_* reason);
+ *                    for DEQUEUE_SLEEP it is the running task
+ *   pick_next        remove and return the task to run next, or NULL
+ *   tick             charge the running task for `ticks` ticks; true
+ *                    if its time slice is used up
+ *   preempt_check    true if a waiting task should preempt the running
+ *                    one now
+ *   slice_left       ticks the running task can run before `tick` or
+ *                    `preempt_check` can give a different answer
+ *   select_migration the waiting task another CPU should take, or NULL
+ *   boost            optional periodic hook, called every
+ *                    `boost_interval` ticks; returns true if it put the
+ *                    running task (possibly NULL) back on the run queue
+ *   oldest_waiting   optional, for adaptive boosts: the `enqueued_at` of
+ *                    the task that has waited longest below the top
+ *                    level, or INT_MAX if none is waiting there
+ *   boost_oldest     optional, for adaptive boosts: moves that task to
+ *                    the top level and returns it
+ *   burst_ordered    true if waiting tasks are ordered by their remaining
+ *                    burst, so one whose burst grows must be requeued
+ */
+typedef struct Sched_class Sched_class_t;
+struct Sched_class {
+    const char  *name;
+    void        *(*create)(const Sched_config_t *);
+    void        (*destroy)(void *rq);
+    void        (*enqueue)(void *rq, Task_t *task, int reason);
+    void        (*dequeue)(void *rq, Task_t *task, int reason);
+    Task_t      *(*pick_next)(void *rq);
+    bool        (*tick)(void *rq, Task_t *curr, int ticks);
+    bool        (*preempt_check)(void *rq, Task_t *curr);
+    int         (*slice_left)(void *rq, Task_t *curr);
+    Task_t      *(*select_migration)(void *rq);
+    bool        (*boost)(void *rq, Task_t *curr);
+    int         (*oldest_waiting)(void *rq);
+    Task_t      *(*boost_oldest)(void *rq);
+    bool        burst_ordered;
+};
+
+extern const Sched_class_t sched_mlfq;
+extern const Sched_class_t sched_cfs;
+extern const Sched_class_t sched_eevdf;
+extern const Sched_class_t sched_stride;
+extern const Sched_class_t sched_srtf;
+extern const Sched_class_t sched_edf;       // Real-time tasks, above the policy
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * sched_cfs.c
+ *
+ * Completely Fair Scheduler, after Linux's: waiting tasks are kept in
+ * a red-black tree ordered by virtual runtime, and the task that has
+ * run least runs next. All tasks have the same weight, so a task's
+ * virtual runtime grows by one per tick it runs.
+ *
+ * The picked task runs for `latency` divided among the runnable tasks,
+ * but at least `granularity` ticks. A new burst preempts the running
+ * task if the latter is ahead of the waker by more than `granularity`.
+ * A task waking up is placed no further back than `latency / 2` behind
+ * the run queue's minimum virtual runtime, so sleeping earns only a
+ * bounded credit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+
+typedef struct Cfs_rq Cfs_rq_t;
+struct Cfs_rq {
+    const Sched_config_t *config;
+    Rb_tree_t   timeline;               // Waiting tasks by vruntime
+    long long   min_vruntime;           // Monotonic floor of the vruntimes
+    Task_t      *curr;
+    int         slice;                  // Ticks granted to `curr`
+    int         slice_used;
+    bool        wakeup;                 // A burst arrived since the last preempt_check
+};
+
+#define task_of(node) rb_entry(node, Task_t, run_node)
+
+
+static int vruntime_less(const Rb_node_t *a, const Rb_node_t *b) {
+    return task_of(a)->vruntime < task_of(b)->vruntime;
+}
+
+
+static Task_t *leftmost(Cfs_rq_t *rq) {
+    Rb_node_t *node = rb_first(&rq->timeline);
+
+    return node == NULL ? NULL : task_of(node);
+}
+
+
+/*
+ * Advance `min_vruntime` to the least vruntime of the running and
+ * waiting tasks, never moving it backwards.
+ */
+static void update_min_vruntime(Cfs_rq_t *rq) {
+    Task_t *first = leftmost(rq);
+    long long vruntime;
+
+    if (rq->curr != NULL) {
+        vruntime = rq->curr->vruntime;
+        if (first != NULL && first->vruntime < vruntime) {
+            vruntime = first->vruntime;
+        }
+    } else if (first != NULL) {
+        vruntime = first->vruntime;
+    } else {
+        return;
+    }
+    if (vruntime > rq->min_vruntime) {
+        rq->min_vruntime = vruntime;
+    }
+}
+
+
+static void *cfs_create(const Sched_config_t *config) {
+    Cfs_rq_t *rq = emalloc(sizeof(Cfs_rq_t));
+
+    rq->config = config;
+    rb_init(&rq->timeline, vruntime_less, NULL);
+    rq->min_vruntime = 0;
+    rq->curr = NULL;
+    rq->slice = rq->slice_used = 0;
+    rq->wakeup = false;
+    return rq;
+}
+
+
+static void cfs_destroy(void *rq) {
+    deallocate(rq);
+}
+
+
+static void cfs_enqueue(void *p, Task_t *task, int reason) {
+    Cfs_rq_t *rq = p;
+
+    switch (reason) {
+    case ENQUEUE_WAKEUP: {
+        long long floor = rq->min_vruntime - rq->config->latency / 2;
+        if (task->vruntime < floor) {
+            task->vruntime = floor;
+        }
+        rq->wakeup = true;
+        break;
+    }
+    case ENQUEUE_MIGRATED:
+        // Made relative to the source CPU's min_vruntime on dequeue
+        task->vruntime += rq->min_vruntime;
+        break;
+    default:
+        rq->curr = NULL;
+        break;
+    }
+    rb_insert(&rq->timeline, &task->run_node);
+    update_min_vruntime(rq);
+}
+
+
+static void cfs_dequeue(void *p, Task_t *task, int reason) {
+    Cfs_rq_t *rq = p;
+
+    if (reason == DEQUEUE_SLEEP) {
+        rq->curr = NULL;
+        return;
+    }
+    rb_erase(&rq->timeline, &task->run_node);
+    task->vruntime -= rq->min_vruntime;
+}
+
+
+static Task_t *cfs_pick_next(void *p) {
+    Cfs_rq_t *rq = p;
+    Task_t *task = leftmost(rq);
+
+    rq->wakeup = false;
+    if (task == NULL) {
+        return NULL;
+    }
+    rb_erase(&rq->timeline, &task->run_node);
+    rq->curr = task;
+
+    rq->slice = rq->config->latency / (rq->timeline.count + 1);
+    if (rq->slice < rq->config->granularity) {
+        rq->slice = rq->config->granularity;
+    }
+    rq->slice_used = 0;
+    return task;
+}
+
+
+static bool cfs_tick(void *p, Task_t *curr, int ticks) {
+    Cfs_rq_t *rq = p;
+
+    curr->vruntime += ticks;
+    rq->slice_used += ticks;
+    update_min_vruntime(rq);
+    return rq->slice_used >= rq->slice;
+}
+
+
+static bool cfs_preempt_check(void *p, Task_t *curr) {
+    Cfs_rq_t *rq = p;
+    Task_t *first = leftmost(rq);
+
+    if (!rq->wakeup) {
+        return false;
+    }
+    rq->wakeup = false;
+    return first != NULL && curr->vruntime - first->vruntime > rq->config->granularity;
+}
+
+
+static int cfs_slice_left(void *p, Task_t *curr) {
+    Cfs_rq_t *rq = p;
+
+    return rq->slice - rq->slice_used;
+}
+
+
+static Task_t *cfs_select_migration(void *p) {
+    return leftmost(p);
+}
+
+
+const Sched_class_t sched_cfs = {
+    .name = "cfs",
+    .create = cfs_create,
+    .destroy = cfs_destroy,
+    .enqueue = cfs_enqueue,
+    .dequeue = cfs_dequeue,
+    .pick_next = cfs_pick_next,
+    .tick = cfs_tick,
+    .preempt_check = cfs_preempt_check,
+    .slice_left = cfs_slice_left,
+    .select_migration = cfs_select_migration,
+    .boost = NULL,
+};
@@ -0,0 +1,118 @@
+/*
+ * sched_edf.c
+ *
+ * Earliest Deadline First, for the real-time tasks of feedbackq.c. It
+ * is not a policy of its own but runs above the chosen one: a CPU runs
+ * its waiting real-time task with the earliest deadline, if it has 
+ * one, before anything else. Ties go to the task that has waited 
+ * longest. The deadlines and budgets are those of each task's constant
+ * bandwidth server, kept by feedbackq.c; this class orders the tasks 
+ * by server deadline and charges the running task's budget, which is 
+ * its time slice. Real-time tasks stay on the CPU they were admitted 
+ * to, so none is ever selected for migration.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+
+typedef struct Edf_rq Edf_rq_t;
+struct Edf_rq {
+    Rb_tree_t   timeline;               // Waiting tasks by server deadline
+};
+
+#define task_of(node) rb_entry(node, Task_t, run_node)
+
+
+static int deadline_less(const Rb_node_t *a, const Rb_node_t *b) {
+    return task_of(a)->rt_server_deadline < task_of(b)->rt_server_deadline;
+}
+
+
+static Task_t *leftmost(Edf_rq_t *rq) {
+    Rb_node_t *node = rb_first(&rq->timeline);
+
+    return node == NULL ? NULL : task_of(node);
+}
+
+
+static void *edf_create(const Sched_config_t *config) {
+    Edf_rq_t *rq = emalloc(sizeof(Edf_rq_t));
+
+    rb_init(&rq->timeline, deadline_less, NULL);
+    return rq;
+}
+
+
+static void edf_destroy(void *rq) {
+    deallocate(rq);
+}
+
+
+static void edf_enqueue(void *p, Task_t *task, int reason) {
+    Edf_rq_t *rq = p;
+
+    rb_insert(&rq->timeline, &task->run_node);
+}
+
+
+static void edf_dequeue(void *p, Task_t *task, int reason) {
+    Edf_rq_t *rq = p;
+
+    if (reason == DEQUEUE_MIGRATE) {
+        rb_erase(&rq->timeline, &task->run_node);
+    }
+}
+
+
+static Task_t *edf_pick_next(void *p) {
+    Edf_rq_t *rq = p;
+    Task_t *task = leftmost(rq);
+
+    if (task != NULL) {
+        rb_erase(&rq->timeline, &task->run_node);
+    }
+    return task;
+}
+
+
+/*
+ * The slice ends when the server's budget runs out, and the task is
+ * then throttled until its replenishment.
+ */
+static bool edf_tick(void *p, Task_t *curr, int ticks) {
+    curr->rt_budget -= ticks;
+    return curr->rt_budget == 0;
+}
+
+
+static bool edf_preempt_check(void *p, Task_t *curr) {
+    Task_t *first = leftmost(p);
+
+    return first != NULL && first->rt_server_deadline < curr->rt_server_deadline;
+}
+
+
+static int edf_slice_left(void *p, Task_t *curr) {
+    return curr->rt_budget;
+}
+
+
+static Task_t *edf_select_migration(void *p) {
+    return NULL;
+}
+
+
+const Sched_class_t sched_edf = {
+    .name = "edf",
+    .create = edf_create,
+    .destroy = edf_destroy,
+    .enqueue = edf_enqueue,
+    .dequeue = edf_dequeue,
+    .pick_next = edf_pick_next,
+    .tick = edf_tick,
+    .preempt_check = edf_preempt_check,
+    .slice_left = edf_slice_left,
+    .select_migration = edf_select_migration,
+    .boost = NULL,
+};
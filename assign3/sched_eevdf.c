@@ -0,0 +1,242 @@
+/*
+ * sched_eevdf.c
+ *
+ * Earliest Eligible Virtual Deadline First, after Stoica et al. and
+ * Linux's EEVDF scheduler. Every task's request is `slice` ticks; its
+ * virtual deadline is its virtual runtime at the start of the request
+ * plus `slice`. A task is eligible if it has received no more service
+ * than its share, i.e. its vruntime is at most the average vruntime V
+ * of the runnable tasks, and the eligible task with the earliest 
+ * virtual deadline runs next.
+ *
+ * Waiting tasks are kept in a red-black tree ordered by deadline, each
+ * node holding the least vruntime in its subtree, so the pick is a 
+ * single descent. A task leaving the run queue keeps its lag (V minus
+ * its vruntime) and gets it back when it returns, and a new burst
+ * preempts the running task if it has an earlier deadline.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+
+typedef struct Eevdf_rq Eevdf_rq_t;
+struct Eevdf_rq {
+    const Sched_config_t *config;
+    Rb_tree_t   timeline;               // Waiting tasks by deadline
+    long long   sum_vruntime;           // Of the runnable tasks, including `curr`
+    int         nr_running;             // Runnable tasks, including `curr`
+    long long   last_avg;               // V when the run queue last emptied
+    Task_t      *curr;
+    int         slice_used;
+    bool        wakeup;                 // A burst arrived since the last preempt_check
+};
+
+#define task_of(node) rb_entry(node, Task_t, run_node)
+
+
+static int deadline_less(const Rb_node_t *a, const Rb_node_t *b) {
+    return task_of(a)->deadline < task_of(b)->deadline;
+}
+
+
+static void update_min_vruntime(Rb_node_t *node) {
+    Task_t *task = task_of(node);
+
+    task->min_vruntime = task->vruntime;
+    if (node->left != NULL && task_of(node->left)->min_vruntime < task->min_vruntime) {
+        task->min_vruntime = task_of(node->left)->min_vruntime;
+    }
+    if (node->right != NULL && task_of(node->right)->min_vruntime < task->min_vruntime) {
+        task->min_vruntime = task_of(node->right)->min_vruntime;
+    }
+}
+
+
+/*
+ * Average vruntime V of the runnable tasks (rounded down).
+ */
+static long long avg_vruntime(Eevdf_rq_t *rq) {
+    long long sum = rq->sum_vruntime;
+
+    if (rq->nr_running == 0) {
+        return rq->last_avg;
+    }
+    if (sum < 0 && sum % rq->nr_running != 0) {
+        return sum / rq->nr_running - 1;
+    }
+    return sum / rq->nr_running;
+}
+
+
+/*
+ * Whether a task with the given vruntime is eligible, i.e. vruntime <= V,
+ * compared without dividing.
+ */
+static bool eligible(Eevdf_rq_t *rq, long long vruntime) {
+    return vruntime * rq->nr_running <= rq->sum_vruntime;
+}
+
+
+/*
+ * The eligible waiting task with the earliest deadline. If a subtree 
+ * to the left (earlier deadlines) holds an eligible task, the answer
+ * is there; otherwise it is the node itself if eligible, or in the
+ * right subtree.
+ */
+static Task_t *pick_eevdf(Eevdf_rq_t *rq) {
+    Rb_node_t *node = rq->timeline.root;
+
+    while (node != NULL) {
+        if (node->left != NULL && eligible(rq, task_of(node->left)->min_vruntime)) {
+            node = node->left;
+        } else if (eligible(rq, task_of(node)->vruntime)) {
+            return task_of(node);
+        } else {
+            node = node->right;
+        }
+    }
+
+    // Only possible if the running task holds all the eligibility
+    node = rb_first(&rq->timeline);
+    return node == NULL ? NULL : task_of(node);
+}
+
+
+static void *eevdf_create(const Sched_config_t *config) {
+    Eevdf_rq_t *rq = emalloc(sizeof(Eevdf_rq_t));
+
+    rq->config = config;
+    rb_init(&rq->timeline, deadline_less, update_min_vruntime);
+    rq->sum_vruntime = 0;
+    rq->nr_running = 0;
+    rq->last_avg = 0;
+    rq->curr = NULL;
+    rq->slice_used = 0;
+    rq->wakeup = false;
+    return rq;
+}
+
+
+static void eevdf_destroy(void *rq) {
+    deallocate(rq);
+}
+
+
+static void eevdf_enqueue(void *p, Task_t *task, int reason) {
+    Eevdf_rq_t *rq = p;
+
+    switch (reason) {
+    case ENQUEUE_WAKEUP:
+        // `vruntime` holds minus the lag the task left with
+        task->vruntime += avg_vruntime(rq);
+        task->deadline = task->vruntime + rq->config->slice;
+        rq->sum_vruntime += task->vruntime;
+        rq->nr_running++;
+        rq->wakeup = true;
+        break;
+    case ENQUEUE_MIGRATED:
+        // Made relative to the source CPU's V on dequeue
+        task->vruntime += avg_vruntime(rq);
+        task->deadline += avg_vruntime(rq);
+        rq->sum_vruntime += task->vruntime;
+        rq->nr_running++;
+        break;
+    case ENQUEUE_EXPIRED:
+        task->deadline = task->vruntime + rq->config->slice;
+        rq->curr = NULL;
+        break;
+    default:
+        rq->curr = NULL;
+        break;
+    }
+    rb_insert(&rq->timeline, &task->run_node);
+}
+
+
+static void eevdf_dequeue(void *p, Task_t *task, int reason) {
+    Eevdf_rq_t *rq = p;
+    long long avg = avg_vruntime(rq);
+
+    if (reason == DEQUEUE_SLEEP) {
+        rq->curr = NULL;
+    } else {
+        rb_erase(&rq->timeline, &task->run_node);
+        task->deadline -= avg;
+    }
+    task->vruntime -= avg;
+    rq->sum_vruntime -= task->vruntime + avg;
+    rq->nr_running--;
+    if (rq->nr_running == 0) {
+        rq->last_avg = avg;
+        rq->sum_vruntime = 0;
+    }
+}
+
+
+static Task_t *eevdf_pick_next(void *p) {
+    Eevdf_rq_t *rq = p;
+    Task_t *task = pick_eevdf(rq);
+
+    rq->wakeup = false;
+    if (task == NULL) {
+        return NULL;
+    }
+    rb_erase(&rq->timeline, &task->run_node);
+    rq->curr = task;
+    rq->slice_used = 0;
+    return task;
+}
+
+
+static bool eevdf_tick(void *p, Task_t *curr, int ticks) {
+    Eevdf_rq_t *rq = p;
+
+    curr->vruntime += ticks;
+    rq->sum_vruntime += ticks;
+    rq->slice_used += ticks;
+    return rq->slice_used >= rq->config->slice;
+}
+
+
+static bool eevdf_preempt_check(void *p, Task_t *curr) {
+    Eevdf_rq_t *rq = p;
+    Task_t *best;
+
+    if (!rq->wakeup) {
+        return false;
+    }
+    rq->wakeup = false;
+    best = pick_eevdf(rq);
+    return best != NULL && eligible(rq, best->vruntime) &&
+        (best->deadline < curr->deadline || !eligible(rq, curr->vruntime));
+}
+
+
+static int eevdf_slice_left(void *p, Task_t *curr) {
+    Eevdf_rq_t *rq = p;
+
+    return rq->config->slice - rq->slice_used;
+}
+
+
+static Task_t *eevdf_select_migration(void *p) {
+    Eevdf_rq_t *rq = p;
+
+    return pick_eevdf(rq);
+}
+
+
+const Sched_class_t sched_eevdf = {
+    .name = "eevdf",
+    .create = eevdf_create,
+    .destroy = eevdf_destroy,
+    .enqueue = eevdf_enqueue,
+    .dequeue = eevdf_dequeue,
+    .pick_next = eevdf_pick_next,
+    .tick = eevdf_tick,
+    .preempt_check = eevdf_preempt_check,
+    .slice_left = eevdf_slice_left,
+    .select_migration = eevdf_select_migration,
+    .boost = NULL,
+};
@@ -0,0 +1,302 @@
+/*
+ * sched_mlfq.c
+ *
+ * Multi-Level Feedback Queue: round-robin queues of increasing quanta.
+ * A task that uses up its quantum drops `demote_step` levels, and every
+ * `boost_interval` ticks all waiting tasks return to queue 1.
+ *
+ * A task's `current_queue` is its level, while `level` is the queue it
+ * is actually waiting in: new bursts always join queue 1, whatever the
+ * task's level, and get queue 1's quantum when picked.
+ *
+ * The queues are chunked FIFOs (see ring_queue.h), so a boost appends
+ * each lower queue to queue 1 in O(1), and costs O(levels) whatever
+ * the number of tasks. The boosted tasks are not relabelled then: each
+ * records the run queue's `boost_epoch` when it was queued, and a task
+ * queued below queue 1 before the latest boost must have been moved to
+ * queue 1 by it, so its level is corrected when it leaves the queue.
+ *
+ * With adaptive boosts (boost_target), tasks are instead boosted one at
+ * a time once they have waited long enough. The queues are FIFO, so
+ * the front of each is the task that has waited longest in it (except
+ * that a task moved from another CPU joins the back), and the oldest
+ * waiting task is found among the fronts of the non-empty queues.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "sched.h"
+#include "ring_queue.h"
+
+typedef struct Mlfq_rq Mlfq_rq_t;
+struct Mlfq_rq {
+    const Sched_config_t *config;
+    Ring_queue_t queues[MAX_LEVELS];    // queues[0] is queue 1 (highest priority)
+    uint64_t    ready_levels;           // Bit `level - 1` is set iff that queue is non-empty
+    unsigned    boost_epoch;            // Number of boosts so far
+    int         remaining_quantum;      // Remaining Time Quantum for the running task
+};
+
+
+/*
+ * Return the id of the highest-priority non-empty queue, or 0 if all
+ * are empty. This is a find-first-set on `ready_levels`, so it costs
+ * the same whatever the number of levels.
+ */
+static int highest_ready_level(Mlfq_rq_t *rq) {
+    if (rq->ready_levels == 0) {
+        return 0;
+    }
+    return __builtin_ctzll(rq->ready_levels) + 1;
+}
+
+
+/*
+ * Add the task to the end of queue `level`.
+ */
+static void push_task(Mlfq_rq_t *rq, int level, Task_t *task) {
+    task->level = level;
+    task->boost_epoch = rq->boost_epoch;
+    ring_push(&rq->queues[level - 1], task);
+    rq->ready_levels |= (uint64_t)1 << (level - 1);
+}
+
+
+/*
+ * Apply the boosts the waiting task has missed: if it was queued below
+ * queue 1 before the latest boost, that boost moved it to queue 1.
+ */
+static void settle_level(Mlfq_rq_t *rq, Task_t *task) {
+    if (task->level > 1 && task->boost_epoch != rq->boost_epoch) {
+        task->current_queue = 1;
+        task->level = 1;
+    }
+}
+
+
+/*
+ * Remove the task at the front of queue `level`.
+ */
+static Task_t *pop_task(Mlfq_rq_t *rq, int level) {
+    Task_t *task = ring_pop(&rq->queues[level - 1]);
+
+    if (ring_size(&rq->queues[level - 1]) == 0) {
+        rq->ready_levels &= ~((uint64_t)1 << (level - 1));
+    }
+    settle_level(rq, task);
+    return task;
+}
+
+
+static void *mlfq_create(const Sched_config_t *config) {
+    Mlfq_rq_t *rq = emalloc(sizeof(Mlfq_rq_t));
+
+    rq->config = config;
+    rq->ready_levels = 0;
+    rq->boost_epoch = 0;
+    rq->remaining_quantum = 0;
+    for (int level = 0; level < config->num_levels; level++) {
+        ring_init(&rq->queues[level]);
+    }
+    return rq;
+}
+
+
+static void mlfq_destroy(void *p) {
+    Mlfq_rq_t *rq = p;
+
+    for (int level = 0; level < rq->config->num_levels; level++) {
+        ring_free(&rq->queues[level]);
+    }
+    deallocate(rq);
+}
+
+
+static void mlfq_enqueue(void *p, Task_t *task, int reason) {
+    Mlfq_rq_t *rq = p;
+
+    switch (reason) {
+    case ENQUEUE_WAKEUP:
+        push_task(rq, 1, task);
+        break;
+    case ENQUEUE_EXPIRED:
+        // Demote by `demote_step`, stopping at the lowest level
+        task->current_queue += rq->config->demote_step;
+        if (task->current_queue > rq->config->num_levels) {
+            task->current_queue = rq->config->num_levels;
+        }
+        push_task(rq, task->current_queue, task);
+        break;
+    case ENQUEUE_MIGRATED:
+        push_task(rq, task->level, task);
+        break;
+    default:
+        push_task(rq, task->current_queue, task);
+        break;
+    }
+}
+
+
+static void mlfq_dequeue(void *p, Task_t *task, int reason) {
+    Mlfq_rq_t *rq = p;
+
+    if (reason == DEQUEUE_SLEEP) {
+        return;
+    }
+
+    settle_level(rq, task);
+    // Migration takes the front of a queue, so this is normally O(1)
+    ring_remove(&rq->queues[task->level - 1], task);
+    if (ring_size(&rq->queues[task->level - 1]) == 0) {
+        rq->ready_levels &= ~((uint64_t)1 << (task->level - 1));
+    }
+}
+
+
+static Task_t *mlfq_pick_next(void *p) {
+    Mlfq_rq_t *rq = p;
+    int level = highest_ready_level(rq);
+
+    if (level == 0) {
+        return NULL;
+    }
+    rq->remaining_quantum = rq->config->time_quantums[level - 1];
+    return pop_task(rq, level);
+}
+
+
+static bool mlfq_tick(void *p, Task_t *curr, int ticks) {
+    Mlfq_rq_t *rq = p;
+
+    rq->remaining_quantum -= ticks;
+    return rq->remaining_quantum == 0;
+}
+
+
+/*
+ * A task in a higher-priority queue than the running task's level
+ * preempts it. New bursts always join queue 1, so this can also hold
+ * right after a demoted task was picked from queue 1.
+ */
+static bool mlfq_preempt_check(void *p, Task_t *curr) {
+    int level = highest_ready_level(p);
+
+    return level != 0 && level < curr->current_queue;
+}
+
+
+static int mlfq_slice_left(void *p, Task_t *curr) {
+    Mlfq_rq_t *rq = p;
+
+    return rq->remaining_quantum;
+}
+
+
+/*
+ * The most urgent waiting task: the front of the highest-priority 
+ * non-empty queue.
+ */
+static Task_t *mlfq_select_migration(void *p) {
+    Mlfq_rq_t *rq = p;
+    int level = highest_ready_level(rq);
+
+    return level == 0 ? NULL : ring_at(&rq->queues[level - 1], 0);
+}
+
+
+/*
+ * Perform a boost on all tasks in the lowest non-empty queue, then the
+ * next lowest, and so on up to Queue 2. A boost is done by splicing the
+ * queue onto the end of Queue 1; its tasks are relabelled as they leave
+ * it (see settle_level). At the end of this process, all tasks with
+ * remaining CPU bursts should be in Queue 1. The running task is 
+ * unaffected if it is at level 1 (and put back at the end of Queue 1
+ * otherwise), except that its remaining quantum is set to a maximum 
+ * of 2.
+ */
+static bool mlfq_boost(void *p, Task_t *curr) {
+    Mlfq_rq_t *rq = p;
+    bool requeued = false;
+
+    if (curr != NULL && curr->current_queue != 1) {
+        curr->current_queue = 1;
+        push_task(rq, 1, curr);
+        requeued = true;
+    }
+
+    if (rq->remaining_quantum > 2) {
+        rq->remaining_quantum = 2;
+    }
+
+    while ((rq->ready_levels & ~(uint64_t)1) != 0) {
+        int level = 64 - __builtin_clzll(rq->ready_levels);
+
+        ring_splice(&rq->queues[0], &rq->queues[level - 1]);
+        rq->ready_levels &= ~((uint64_t)1 << (level - 1));
+        rq->ready_levels |= 1;
+    }
+    rq->boost_epoch++;
+    return requeued;
+}
+
+
+/*
+ * Return the level below queue 1 whose front task has waited longest,
+ * or 0 if those queues are all empty. Ties go to the higher priority.
+ */
+static int oldest_level(Mlfq_rq_t *rq) {
+    uint64_t levels = rq->ready_levels & ~(uint64_t)1;
+    int oldest = 0;
+
+    while (levels != 0) {
+        int level = __builtin_ctzll(levels) + 1;
+
+        levels &= levels - 1;
+        if (oldest == 0 || ring_at(&rq->queues[level - 1], 0)->enqueued_at <
+            ring_at(&rq->queues[oldest - 1], 0)->enqueued_at) {
+            oldest = level;
+        }
+    }
+    return oldest;
+}
+
+
+static int mlfq_oldest_waiting(void *p) {
+    Mlfq_rq_t *rq = p;
+    int level = oldest_level(rq);
+
+    return level == 0 ? INT_MAX : ring_at(&rq->queues[level - 1], 0)->enqueued_at;
+}
+
+
+/*
+ * Move the task that has waited longest below queue 1 to the end of
+ * queue 1, as a boost would.
+ */
+static Task_t *mlfq_boost_oldest(void *p) {
+    Mlfq_rq_t *rq = p;
+    Task_t *task = pop_task(rq, oldest_level(rq));
+
+    task->current_queue = 1;
+    push_task(rq, 1, task);
+    return task;
+}
+
+
+const Sched_class_t sched_mlfq = {
+    .name = "mlfq",
+    .create = mlfq_create,
+    .destroy = mlfq_destroy,
+    .enqueue = mlfq_enqueue,
+    .dequeue = mlfq_dequeue,
+    .pick_next = mlfq_pick_next,
+    .tick = mlfq_tick,
+    .preempt_check = mlfq_preempt_check,
+    .slice_left = mlfq_slice_left,
+    .select_migration = mlfq_select_migration,
+    .boost = mlfq_boost,
+    .oldest_waiting = mlfq_oldest_waiting,
+    .boost_oldest = mlfq_boost_oldest,
+};
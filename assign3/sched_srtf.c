@@ -0,0 +1,126 @@
+/*
+ * sched_srtf.c
+ *
+ * Shortest Remaining Time First: the waiting task with the least of 
+ * its burst left runs next, and runs until its burst completes unless
+ * a task with less left arrives. Ties go to the task that has waited
+ * longest. Waiting tasks are kept in a red-black tree ordered by their
+ * remaining burst time; the simulator requeues a waiting task whose
+ * burst grows (see `burst_ordered`).
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+
+typedef struct Srtf_rq Srtf_rq_t;
+struct Srtf_rq {
+    Rb_tree_t   timeline;               // Waiting tasks by remaining burst time
+};
+
+#define task_of(node) rb_entry(node, Task_t, run_node)
+
+
+static int remaining_less(const Rb_node_t *a, const Rb_node_t *b) {
+    const Task_t *ta = task_of(a), *tb = task_of(b);
+
+    if (ta->remaining_burst_time != tb->remaining_burst_time) {
+        return ta->remaining_burst_time < tb->remaining_burst_time;
+    }
+    return ta->enqueued_at < tb->enqueued_at;
+}
+
+
+static Task_t *leftmost(Srtf_rq_t *rq) {
+    Rb_node_t *node = rb_first(&rq->timeline);
+
+    return node == NULL ? NULL : task_of(node);
+}
+
+
+static void *srtf_create(const Sched_config_t *config) {
+    Srtf_rq_t *rq = emalloc(sizeof(Srtf_rq_t));
+
+    rb_init(&rq->timeline, remaining_less, NULL);
+    return rq;
+}
+
+
+static void srtf_destroy(void *rq) {
+    deallocate(rq);
+}
+
+
+static void srtf_enqueue(void *p, Task_t *task, int reason) {
+    Srtf_rq_t *rq = p;
+
+    rb_insert(&rq->timeline, &task->run_node);
+}
+
+
+static void srtf_dequeue(void *p, Task_t *task, int reason) {
+    Srtf_rq_t *rq = p;
+
+    if (reason == DEQUEUE_MIGRATE) {
+        rb_erase(&rq->timeline, &task->run_node);
+    }
+}
+
+
+static Task_t *srtf_pick_next(void *p) {
+    Srtf_rq_t *rq = p;
+    Task_t *task = leftmost(rq);
+
+    if (task != NULL) {
+        rb_erase(&rq->timeline, &task->run_node);
+    }
+    return task;
+}
+
+
+/*
+ * There is no time slice: the running task only leaves the CPU when
+ * its burst completes or it is preempted.
+ */
+static bool srtf_tick(void *p, Task_t *curr, int ticks) {
+    return false;
+}
+
+
+/*
+ * Between instructions the running task's remaining time only shrinks
+ * while the waiting tasks' keys stay put, so this can only become true
+ * when an instruction is handled.
+ */
+static bool srtf_preempt_check(void *p, Task_t *curr) {
+    Task_t *first = leftmost(p);
+
+    return first != NULL && first->remaining_burst_time < curr->remaining_burst_time;
+}
+
+
+static int srtf_slice_left(void *p, Task_t *curr) {
+    return INT_MAX;
+}
+
+
+static Task_t *srtf_select_migration(void *p) {
+    return leftmost(p);
+}
+
+
+const Sched_class_t sched_srtf = {
+    .name = "srtf",
+    .create = srtf_create,
+    .destroy = srtf_destroy,
+    .enqueue = srtf_enqueue,
+    .dequeue = srtf_dequeue,
+    .pick_next = srtf_pick_next,
+    .tick = srtf_tick,
+    .preempt_check = srtf_preempt_check,
+    .slice_left = srtf_slice_left,
+    .select_migration = srtf_select_migration,
+    .boost = NULL,
+    .burst_ordered = true,
+};
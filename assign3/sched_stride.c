@@ -0,0 +1,177 @@
+/*
+ * sched_stride.c
+ *
+ * Stride scheduling (Waldspurger and Weihl, 1995). Each task holds 
+ * tickets and advances its pass by its stride, STRIDE1 / tickets, for
+ * every tick it runs; the task with the lowest pass runs next, for a
+ * quantum of `slice` ticks. The case files carry no ticket counts, so
+ * every task holds DEFAULT_TICKETS.
+ *
+ * A new burst joins at the global pass (the lowest pass of the run 
+ * queue), so that time spent not runnable is neither a credit nor a 
+ * debt. The pass is kept in the task's `vruntime`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sched.h"
+
+#define STRIDE1 (1 << 20)
+#define DEFAULT_TICKETS 100
+
+typedef struct Stride_rq Stride_rq_t;
+struct Stride_rq {
+    const Sched_config_t *config;
+    Rb_tree_t   timeline;               // Waiting tasks by pass
+    long long   global_pass;            // Monotonic floor of the passes
+    Task_t      *curr;
+    int         slice_used;
+};
+
+#define task_of(node) rb_entry(node, Task_t, run_node)
+
+
+static int pass_less(const Rb_node_t *a, const Rb_node_t *b) {
+    return task_of(a)->vruntime < task_of(b)->vruntime;
+}
+
+
+static Task_t *leftmost(Stride_rq_t *rq) {
+    Rb_node_t *node = rb_first(&rq->timeline);
+
+    return node == NULL ? NULL : task_of(node);
+}
+
+
+/*
+ * Advance the global pass to the lowest pass of the running and 
+ * waiting tasks, never moving it backwards.
+ */
+static void update_global_pass(Stride_rq_t *rq) {
+    Task_t *first = leftmost(rq);
+    long long pass;
+
+    if (rq->curr != NULL) {
+        pass = rq->curr->vruntime;
+        if (first != NULL && first->vruntime < pass) {
+            pass = first->vruntime;
+        }
+    } else if (first != NULL) {
+        pass = first->vruntime;
+    } else {
+        return;
+    }
+    if (pass > rq->global_pass) {
+        rq->global_pass = pass;
+    }
+}
+
+
+static void *stride_create(const Sched_config_t *config) {
+    Stride_rq_t *rq = emalloc(sizeof(Stride_rq_t));
+
+    rq->config = config;
+    rb_init(&rq->timeline, pass_less, NULL);
+    rq->global_pass = 0;
+    rq->curr = NULL;
+    rq->slice_used = 0;
+    return rq;
+}
+
+
+static void stride_destroy(void *rq) {
+    deallocate(rq);
+}
+
+
+static void stride_enqueue(void *p, Task_t *task, int reason) {
+    Stride_rq_t *rq = p;
+
+    switch (reason) {
+    case ENQUEUE_WAKEUP:
+        if (task->vruntime < rq->global_pass) {
+            task->vruntime = rq->global_pass;
+        }
+        break;
+    case ENQUEUE_MIGRATED:
+        // Made relative to the source CPU's global pass on dequeue
+        task->vruntime += rq->global_pass;
+        break;
+    default:
+        rq->curr = NULL;
+        break;
+    }
+    rb_insert(&rq->timeline, &task->run_node);
+    update_global_pass(rq);
+}
+
+
+static void stride_dequeue(void *p, Task_t *task, int reason) {
+    Stride_rq_t *rq = p;
+
+    if (reason == DEQUEUE_SLEEP) {
+        rq->curr = NULL;
+        return;
+    }
+    rb_erase(&rq->timeline, &task->run_node);
+    task->vruntime -= rq->global_pass;
+}
+
+
+static Task_t *stride_pick_next(void *p) {
+    Stride_rq_t *rq = p;
+    Task_t *task = leftmost(rq);
+
+    if (task == NULL) {
+        return NULL;
+    }
+    rb_erase(&rq->timeline, &task->run_node);
+    rq->curr = task;
+    rq->slice_used = 0;
+    return task;
+}
+
+
+static bool stride_tick(void *p, Task_t *curr, int ticks) {
+    Stride_rq_t *rq = p;
+
+    curr->vruntime += (long long)ticks * (STRIDE1 / DEFAULT_TICKETS);
+    rq->slice_used += ticks;
+    update_global_pass(rq);
+    return rq->slice_used >= rq->config->slice;
+}
+
+
+/*
+ * Stride scheduling switches tasks only at the end of a quantum.
+ */
+static bool stride_preempt_check(void *p, Task_t *curr) {
+    return false;
+}
+
+
+static int stride_slice_left(void *p, Task_t *curr) {
+    Stride_rq_t *rq = p;
+
+    return rq->config->slice - rq->slice_used;
+}
+
+
+static Task_t *stride_select_migration(void *p) {
+    return leftmost(p);
+}
+
+
+const Sched_class_t sched_stride = {
+    .name = "stride",
+    .create = stride_create,
+    .destroy = stride_destroy,
+    .enqueue = stride_enqueue,
+    .dequeue = stride_dequeue,
+    .pick_next = stride_pick_next,
+    .tick = stride_tick,
+    .preempt_check = stride_preempt_check,
+    .slice_left = stride_slice_left,
+    .select_migration = stride_select_migration,
+    .boost = NULL,
+};
@@ -0,0 +1,537 @@
+/*
+ * simbench.c
+ *
+ * Throughput benchmark and golden-output check of feedbackq.
+ * --------------------
+ * 	1) Benchmark: for each size n, a case file of n tasks is generated
+ * 	   with casegen and simulated by feedbackq, whose output is read
+ * 	   (and discarded) through a pipe. The best of the runs' CPU times
+ * 	   gives the simulated ticks per second and the events (case file
+ * 	   instructions) per second.
+ * 	2) Check: each simulation listed in the golden directory's
+ * 	   manifest is run, and its standard output compared byte for byte
+ * 	   with the stored `<name>.out`, so that changes to the scheduler
+ * 	   core can be shown not to change any result. With --update, the
+ * 	   stored outputs are rewritten instead.
+ *
+ * Input: Command Line args
+ * ------------------------
+ * 	./simbench [--sizes=n1,n2,...] [--seed=s] [--repeat=r] [--options="..."]
+ * 	./simbench --check[=<dir>] [--update]
+ * 	e.g.
+ * 	     ./simbench --sizes=100000 --options="--compress --cpus=4"
+ * 	     ./simbench --check
+ *
+ * 	--sizes=<n>,...  Tasks in each generated case (default
+ * 	                 1000,10000,100000).
+ * 	--seed=<s>       casegen seed (default 1).
+ * 	--repeat=<r>     Runs of each size; the fastest counts (default 3).
+ * 	--options=<o>    feedbackq options, separated by spaces (default
+ * 	                 none: the per-tick text output).
+ * 	--check[=<dir>]  Run the golden check of the directory (default
+ * 	                 "golden") instead of the benchmark.
+ * 	--update         With --check, store the outputs as the golden ones.
+ * 	--simulator=<p>  feedbackq to run (default ./feedbackq).
+ * 	--casegen=<p>    casegen to run (default ./casegen).
+ *
+ * Golden directory:
+ * -----------------------
+ * 	The file `manifest` has one line per simulation,
+ *
+ * 	<name> <case file> [feedbackq options]
+ *
+ * 	with the case file relative to the directory; blank lines and
+ * 	lines starting with `#` are skipped. The expected output of each
+ * 	is `<name>.out`.
+ *
+ * Output:
+ * -----------------------
+ * 	Benchmark: one line per size,
+ *
+ * 	tasks=<n> events=<n> ticks=<n> lines=<n> cpu=<s> ticks_per_s=<r> events_per_s=<r>
+ *
+ * 	where `ticks` is the last tick simulated and `lines` the lines of
+ * 	output. Check: one line per simulation, `ok <name>` or `FAIL
+ * 	<name>` with the first line that differs, then the number of
+ * 	failures; the exit status is 1 if there were any.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define MAX_ARGS 64
+#define MAX_SIZES 32
+#define MAX_LINE 1024
+
+
+/*
+ * What one run of the simulator printed and the CPU time it took.
+ */
+typedef struct Run Run_t;
+struct Run {
+	char		*output;			// Standard output, if kept
+	long		length;
+	long		lines;
+	long		last_tick;			// Of the last line starting with a tick
+	double		cpu_seconds;		// User and system time of the simulator
+	int			status;
+};
+
+
+char *simulator = "./feedbackq";
+char *casegen = "./casegen";
+int sizes[MAX_SIZES] = { 1000, 10000, 100000 };
+int num_sizes = 3;
+char *seed = "1";
+int repeat = 3;
+char *options = "";
+char *golden_dir = NULL;			// --check
+bool update = false;
+
+
+
+/*
+ * Function: split_args
+ * --------------------
+ *  Splits the text at spaces and tabs into `args`, from `args[count]`
+ *  on, and returns the new count. The text is modified.
+ */
+int split_args(char *text, char *args[], int count) {
+	for(char *arg = strtok(text, " \t\n"); arg != NULL; arg = strtok(NULL, " \t\n")) {
+		if(count == MAX_ARGS - 2) {
+			fprintf(stderr, "Too many arguments\n");
+			exit(1);
+		}
+		args[count++] = arg;
+	}
+	return count;
+}
+
+
+
+/*
+ * Function: note_lines
+ * --------------------
+ *  Counts the lines in the chunk of output and notes the tick of the
+ *  last one starting with `[<tick>]` or `[<tick>-<tick>]`.
+ *
+ *  run: Run the output belongs to
+ *  chunk: Output just read
+ *  length: Bytes in the chunk
+ *  line: The current line so far, carried over between chunks
+ *  line_length: Bytes in `line`
+ */
+void note_lines(Run_t *run, const char *chunk, long length, char *line, int *line_length) {
+	for(long i = 0; i < length; i++) {
+		if(chunk[i] != '\n') {
+			if(*line_length < MAX_LINE - 1) {
+				line[(*line_length)++] = chunk[i];
+			}
+			continue;
+		}
+		line[*line_length] = '\0';
+		if(line[0] == '[') {
+			char *dash = strchr(line, '-');
+			char *end = strchr(line, ']');
+
+			if(end != NULL) {
+				run->last_tick = atol(dash != NULL && dash < end ? dash + 1 : line + 1);
+			}
+		}
+		run->lines++;
+		*line_length = 0;
+	}
+}
+
+
+
+/*
+ * Function: run_program
+ * ---------------------
+ *  Runs the program with the arguments, its standard output going to
+ *  `out_fd` if it is not -1, and otherwise read into the run (and kept
+ *  if `keep` is set). Waits for it to finish and records its CPU time.
+ *
+ *  args: Program and arguments, NULL-terminated
+ *  out_fd: File to write the output to, or -1
+ *  keep: Keep the output read in `run->output`
+ *  run: Where to record the run
+ */
+void run_program(char *args[], int out_fd, bool keep, Run_t *run) {
+	int pipe_fds[2];
+	struct rusage usage;
+	char chunk[1 << 16];
+	char line[MAX_LINE];
+	int line_length = 0;
+	long capacity = 0;
+	long n;
+	pid_t pid;
+
+	memset(run, 0, sizeof(Run_t));
+	if(out_fd == -1 && pipe(pipe_fds) != 0) {
+		perror("pipe");
+		exit(1);
+	}
+
+	pid = fork();
+	if(pid < 0) {
+		perror("fork");
+		exit(1);
+	}
+	if(pid == 0) {
+		if(out_fd == -1) {
+			dup2(pipe_fds[1], STDOUT_FILENO);
+			close(pipe_fds[0]);
+			close(pipe_fds[1]);
+		} else {
+			dup2(out_fd, STDOUT_FILENO);
+		}
+		execv(args[0], args);
+		fprintf(stderr, "Cannot run %s\n", args[0]);
+		_exit(127);
+	}
+
+	if(out_fd == -1) {
+		close(pipe_fds[1]);
+		while((n = read(pipe_fds[0], chunk, sizeof(chunk))) > 0) {
+			note_lines(run, chunk, n, line, &line_length);
+			if(keep) {
+				if(run->length + n > capacity) {
+					capacity = capacity == 0 ? sizeof(chunk) : capacity * 2;
+					while(capacity < run->length + n) {
+						capacity *= 2;
+					}
+					run->output = realloc(run->output, capacity);
+					if(run->output == NULL) {
+						fprintf(stderr, "Out of memory.\n");
+						exit(1);
+					}
+				}
+				memcpy(run->output + run->length, chunk, n);
+			}
+			run->length += n;
+		}
+		close(pipe_fds[0]);
+	}
+
+	if(wait4(pid, &run->status, 0, &usage) < 0) {
+		perror("wait4");
+		exit(1);
+	}
+	run->cpu_seconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+		usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+}
+
+
+
+/*
+ * Function: count_lines
+ * ---------------------
+ *  Returns the number of lines in the file.
+ */
+long count_lines(const char *path) {
+	FILE *fp = fopen(path, "r");
+	long lines = 0;
+	int c;
+
+	if(fp == NULL) {
+		fprintf(stderr, "Cannot open %s\n", path);
+		exit(1);
+	}
+	while((c = getc(fp)) != EOF) {
+		lines += c == '\n';
+	}
+	fclose(fp);
+	return lines;
+}
+
+
+
+/*
+ * Function: bench_size
+ * --------------------
+ *  Generates a case of `tasks` tasks into a temporary file and prints
+ *  the benchmark line of its fastest simulation.
+ */
+void bench_size(int tasks) {
+	char case_path[] = "/tmp/simbenchXXXXXX";
+	char tasks_arg[32], seed_arg[64];
+	char *args[MAX_ARGS];
+	char *options_copy = strdup(options);
+	double best = -1;
+	Run_t run;
+	long events;
+	long lines = 0, last_tick = 0;
+	int count, fd;
+
+	fd = mkstemp(case_path);
+	if(fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	snprintf(tasks_arg, sizeof(tasks_arg), "--tasks=%d", tasks);
+	snprintf(seed_arg, sizeof(seed_arg), "--seed=%s", seed);
+	args[0] = casegen;
+	args[1] = tasks_arg;
+	args[2] = seed_arg;
+	args[3] = NULL;
+	run_program(args, fd, false, &run);
+	close(fd);
+	if(run.status != 0) {
+		fprintf(stderr, "%s failed\n", casegen);
+		exit(1);
+	}
+	events = count_lines(case_path);
+
+	args[0] = simulator;
+	count = split_args(options_copy, args, 1);
+	args[count++] = case_path;
+	args[count] = NULL;
+	for(int r = 0; r < repeat; r++) {
+		run_program(args, -1, false, &run);
+		if(run.status != 0) {
+			fprintf(stderr, "%s failed on %d tasks\n", simulator, tasks);
+			exit(1);
+		}
+		if(best < 0 || run.cpu_seconds < best) {
+			best = run.cpu_seconds;
+		}
+		lines = run.lines;
+		last_tick = run.last_tick;
+	}
+	if(best <= 0) {
+		best = 1e-6;
+	}
+
+	printf("tasks=%d events=%ld ticks=%ld lines=%ld cpu=%.3fs ticks_per_s=%.0f events_per_s=%.0f\n",
+		tasks, events, last_tick, lines, best, last_tick / best, events / best);
+	fflush(stdout);
+	unlink(case_path);
+	free(options_copy);
+}
+
+
+
+/*
+ * Function: read_file
+ * -------------------
+ *  Reads the whole file into memory, setting `length`. Returns NULL if
+ *  it cannot be opened.
+ */
+char *read_file(const char *path, long *length) {
+	FILE *fp = fopen(path, "rb");
+	char *data;
+
+	if(fp == NULL) {
+		return NULL;
+	}
+	fseek(fp, 0, SEEK_END);
+	*length = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	data = malloc(*length + 1);
+	if(data == NULL || fread(data, 1, *length, fp) != (size_t)*length) {
+		fprintf(stderr, "Cannot read %s\n", path);
+		exit(1);
+	}
+	fclose(fp);
+	return data;
+}
+
+
+
+/*
+ * Function: print_difference
+ * --------------------------
+ *  Prints the first line at which the output differs from the
+ *  expected one.
+ */
+void print_difference(const char *expected, long expected_length, const char *actual, long actual_length) {
+	long line = 1, start = 0, i = 0;
+
+	while(i < expected_length && i < actual_length && expected[i] == actual[i]) {
+		if(expected[i] == '\n') {
+			line++;
+			start = i + 1;
+		}
+		i++;
+	}
+	printf("    line %ld\n", line);
+	for(int side = 0; side < 2; side++) {
+		const char *text = side == 0 ? expected : actual;
+		long length = side == 0 ? expected_length : actual_length;
+		long end = start;
+
+		while(end < length && text[end] != '\n') {
+			end++;
+		}
+		if(start < length) {
+			printf("    %s %.*s\n", side == 0 ? "expected:" : "actual:  ", (int)(end - start), text + start);
+		} else {
+			printf("    %s (end of output)\n", side == 0 ? "expected:" : "actual:  ");
+		}
+	}
+}
+
+
+
+/*
+ * Function: check_golden
+ * ----------------------
+ *  Runs every simulation in the golden directory's manifest and
+ *  compares (or, with --update, stores) its output. Returns the number
+ *  of failures.
+ */
+int check_golden() {
+	char path[4096], case_path[4096], line[MAX_LINE];
+	char *args[MAX_ARGS];
+	int failures = 0, checked = 0;
+	FILE *manifest;
+
+	snprintf(path, sizeof(path), "%s/manifest", golden_dir);
+	manifest = fopen(path, "r");
+	if(manifest == NULL) {
+		fprintf(stderr, "Cannot open %s\n", path);
+		exit(1);
+	}
+
+	while(fgets(line, sizeof(line), manifest) != NULL) {
+		char *name = strtok(line, " \t\n");
+		char *case_file = strtok(NULL, " \t\n");
+		char *case_options = strtok(NULL, "\n");
+		char *expected;
+		long expected_length;
+		Run_t run;
+		int count;
+
+		if(name == NULL || name[0] == '#') {
+			continue;
+		}
+		if(case_file == NULL) {
+			fprintf(stderr, "No case file for \"%s\" in %s\n", name, path);
+			exit(1);
+		}
+		snprintf(case_path, sizeof(case_path), "%s/%s", golden_dir, case_file);
+		args[0] = simulator;
+		count = case_options != NULL ? split_args(case_options, args, 1) : 1;
+		args[count++] = case_path;
+		args[count] = NULL;
+		run_program(args, -1, true, &run);
+		checked++;
+
+		snprintf(path, sizeof(path), "%s/%s.out", golden_dir, name);
+		if(update && run.status != 0) {
+			fprintf(stderr, "%s failed on \"%s\"; not updated\n", simulator, name);
+			exit(1);
+		} else if(update) {
+			FILE *fp = fopen(path, "wb");
+
+			if(fp == NULL || fwrite(run.output, 1, run.length, fp) != (size_t)run.length) {
+				fprintf(stderr, "Cannot write %s\n", path);
+				exit(1);
+			}
+			fclose(fp);
+			printf("updated %s\n", name);
+			free(run.output);
+			continue;
+		}
+
+		expected = read_file(path, &expected_length);
+		if(expected == NULL) {
+			printf("FAIL %s: no %s\n", name, path);
+			failures++;
+		} else if(run.status != 0 || run.length != expected_length ||
+			memcmp(run.output, expected, expected_length) != 0) {
+			printf("FAIL %s\n", name);
+			if(run.status != 0) {
+				printf("    exit status %d\n", WEXITSTATUS(run.status));
+			}
+			if(run.length != expected_length || memcmp(run.output, expected, expected_length) != 0) {
+				print_difference(expected, expected_length, run.output, run.length);
+			}
+			failures++;
+		} else {
+			printf("ok %s\n", name);
+		}
+		free(expected);
+		free(run.output);
+	}
+	fclose(manifest);
+
+	if(!update) {
+		printf("%d of %d failed\n", failures, checked);
+	}
+	return failures;
+}
+
+
+
+/*
+ * Function: validate_args
+ * -----------------------
+ */
+void validate_args(int argc, char *argv[]) {
+	for(int i = 1; i < argc; i++) {
+		if(strncmp(argv[i], "--sizes=", 8) == 0) {
+			num_sizes = 0;
+			for(char *size = strtok(argv[i] + 8, ","); size != NULL; size = strtok(NULL, ",")) {
+				if(num_sizes == MAX_SIZES || atoi(size) < 1) {
+					fprintf(stderr, "Invalid size \"%s\"\n", size);
+					exit(1);
+				}
+				sizes[num_sizes++] = atoi(size);
+			}
+		} else if(strncmp(argv[i], "--seed=", 7) == 0) {
+			seed = argv[i] + 7;
+		} else if(strncmp(argv[i], "--repeat=", 9) == 0) {
+			repeat = atoi(argv[i] + 9);
+		} else if(strncmp(argv[i], "--options=", 10) == 0) {
+			options = argv[i] + 10;
+		} else if(strcmp(argv[i], "--check") == 0) {
+			golden_dir = "golden";
+		} else if(strncmp(argv[i], "--check=", 8) == 0) {
+			golden_dir = argv[i] + 8;
+		} else if(strcmp(argv[i], "--update") == 0) {
+			update = true;
+		} else if(strncmp(argv[i], "--simulator=", 12) == 0) {
+			simulator = argv[i] + 12;
+		} else if(strncmp(argv[i], "--casegen=", 10) == 0) {
+			casegen = argv[i] + 10;
+		} else {
+			fprintf(stderr, "usage: simbench [--sizes=n1,n2,...] [--seed=s] [--repeat=r] [--options=\"...\"]\n"
+				"       simbench --check[=dir] [--update]\n");
+			exit(1);
+		}
+	}
+	if(num_sizes == 0 || repeat < 1) {
+		fprintf(stderr, "Invalid argument\n");
+		exit(1);
+	}
+	if(update && golden_dir == NULL) {
+		fprintf(stderr, "--update needs --check\n");
+		exit(1);
+	}
+}
+
+
+
+/*
+ * Function: main
+ * --------------
+ */
+int main(int argc, char *argv[]) {
+	validate_args(argc, argv);
+
+	if(golden_dir != NULL) {
+		return check_golden() > 0 ? 1 : 0;
+	}
+	for(int s = 0; s < num_sizes; s++) {
+		bench_size(sizes[s]);
+	}
+	return 0;
+}
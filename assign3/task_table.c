@@ -0,0 +1,236 @@
+/*
+ * task_table.c
+ *
+ * Growable table of the tasks known to the simulator. Tasks live in
+ * fixed-size slabs that are never moved or freed until the end of the
+ * simulation, so pointers to them (e.g., from the queues) stay valid
+ * as the table grows. Ids may be sparse; they are mapped to slab slots
+ * by a hash index using linear probing.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "task_table.h"
+
+#define INDEX_MIN_CAPACITY 16
+#define EMPTY_SLOT -1
+
+typedef struct Index_entry Index_entry_t;
+struct Index_entry {
+    int id;
+    int slot;       // Slab slot of the task, or EMPTY_SLOT
+};
+
+/*
+ * The table is per thread, so that the simulations a sweep runs on
+ * several threads (see feedbackq.c) each have their own.
+ */
+static __thread Task_t **slabs = NULL;      // slabs[i] holds slots [i * TASK_SLAB_SIZE, ...)
+static __thread int num_slabs = 0;
+static __thread int num_slots = 0;          // Slots handed out so far
+static __thread Task_t *free_tasks = NULL;  // Released tasks, linked through `next`
+
+static __thread Index_entry_t *index_entries = NULL;
+static __thread int index_capacity = 0;     // Always a power of two
+static __thread int index_shift = 32;       // 32 - log2(index_capacity)
+static __thread int num_tasks = 0;
+
+
+/*
+ * Fibonacci hashing of a task id into the index. The top bits of the
+ * product are taken, as they depend on every bit of the id.
+ */
+static int index_home(int id) {
+    return (int)(((uint32_t)id * 2654435769u) >> index_shift);
+}
+
+
+/*
+ * Returns the index position holding `id`, or the empty position at
+ * which it would be inserted.
+ */
+static int index_find(int id) {
+    int pos = index_home(id);
+
+    while (index_entries[pos].slot != EMPTY_SLOT && index_entries[pos].id != id) {
+        pos = (pos + 1) & (index_capacity - 1);
+    }
+    return pos;
+}
+
+
+/*
+ * Returns the task held in the given slab slot.
+ */
+static Task_t *slot_task(int slot) {
+    return &slabs[slot / TASK_SLAB_SIZE][slot % TASK_SLAB_SIZE];
+}
+
+
+/*
+ * Rebuilds the index with the given capacity.
+ */
+static void index_resize(int capacity) {
+    Index_entry_t *old_entries = index_entries;
+    int old_capacity = index_capacity;
+    int i;
+
+    index_entries = (Index_entry_t *) emalloc(capacity * sizeof(Index_entry_t));
+    index_capacity = capacity;
+    index_shift = 32 - __builtin_ctz(capacity);
+    for (i = 0; i < capacity; i++) {
+        index_entries[i].slot = EMPTY_SLOT;
+    }
+
+    for (i = 0; i < old_capacity; i++) {
+        if (old_entries[i].slot != EMPTY_SLOT) {
+            index_entries[index_find(old_entries[i].id)] = old_entries[i];
+        }
+    }
+    free(old_entries);
+}
+
+
+/*
+ * Hands out a task from the free list, or from a fresh slot (adding a
+ * slab if the last one is full). Returns the slot through `slot`.
+ */
+static Task_t *allocate_task(int *slot) {
+    Task_t *task;
+
+    if (free_tasks != NULL) {
+        task = free_tasks;
+        free_tasks = task->next;
+        *slot = task->slot;
+        return task;
+    }
+
+    if (num_slots == num_slabs * TASK_SLAB_SIZE) {
+        slabs = (Task_t **) realloc(slabs, (num_slabs + 1) * sizeof(Task_t *));
+        if (slabs == NULL) {
+            fprintf(stderr, "realloc of task slabs failed");
+            exit(1);
+        }
+        slabs[num_slabs++] = (Task_t *) emalloc(TASK_SLAB_SIZE * sizeof(Task_t));
+    }
+
+    *slot = num_slots++;
+    return slot_task(*slot);
+}
+
+
+/*
+ * Initialize an empty task table.
+ */
+void task_table_init() {
+    index_capacity = 0;
+    index_entries = NULL;
+    index_resize(INDEX_MIN_CAPACITY);
+}
+
+
+/*
+ * Release all memory held by the table. Any Task_t still referenced
+ * becomes invalid.
+ */
+void task_table_free() {
+    for (int i = 0; i < num_slabs; i++) {
+        free(slabs[i]);
+    }
+    free(slabs);
+    free(index_entries);
+
+    slabs = NULL;
+    num_slabs = num_slots = num_tasks = 0;
+    free_tasks = NULL;
+    index_entries = NULL;
+    index_capacity = 0;
+    index_shift = 32;
+}
+
+
+/*
+ * Create a task with the given id, zero-initialized apart from its id
+ * and slot. If a task with that id already exists, it is returned
+ * unchanged.
+ */
+Task_t *task_table_create(int id) {
+    Task_t *task;
+    int pos, slot;
+
+    pos = index_find(id);
+    if (index_entries[pos].slot != EMPTY_SLOT) {
+        return slot_task(index_entries[pos].slot);
+    }
+
+    task = allocate_task(&slot);
+    memset(task, 0, sizeof(Task_t));
+    task->id = id;
+    task->slot = slot;
+
+    index_entries[pos].id = id;
+    index_entries[pos].slot = slot;
+    num_tasks++;
+
+    // Keep the load factor at or below one half
+    if (num_tasks * 2 > index_capacity) {
+        index_resize(index_capacity * 2);
+    }
+    return task;
+}
+
+
+/*
+ * Returns the task with the given id, or NULL if there is none.
+ */
+Task_t *task_table_lookup(int id) {
+    int pos = index_find(id);
+
+    if (index_entries[pos].slot == EMPTY_SLOT) {
+        return NULL;
+    }
+    return slot_task(index_entries[pos].slot);
+}
+
+
+/*
+ * Remove the task from the table and recycle its slot. The task must
+ * not be in any queue.
+ */
+void task_table_release(Task_t *task) {
+    int pos = index_find(task->id);
+    int next, home;
+
+    assert(index_entries[pos].slot == task->slot);
+
+    // Backward-shift deletion: pull later entries of the probe run
+    // into the hole so no tombstones are needed
+    next = pos;
+    for (;;) {
+        next = (next + 1) & (index_capacity - 1);
+        if (index_entries[next].slot == EMPTY_SLOT) {
+            break;
+        }
+        home = index_home(index_entries[next].id);
+        if (((next - home) & (index_capacity - 1)) >= ((next - pos) & (index_capacity - 1))) {
+            index_entries[pos] = index_entries[next];
+            pos = next;
+        }
+    }
+    index_entries[pos].slot = EMPTY_SLOT;
+    num_tasks--;
+
+    task->next = free_tasks;
+    free_tasks = task;
+}
+
+
+/*
+ * Return the number of tasks in the table.
+ */
+int task_table_count() {
+    return num_tasks;
+}
@@ -0,0 +1,22 @@
+#ifndef _TASK_TABLE_H_
+#define _TASK_TABLE_H_
+
+#include "queue.h"
+
+/*
+ * Tasks are allocated from slabs of TASK_SLAB_SIZE entries, so a Task_t
+ * never moves once created, and found by id through an open-addressing
+ * hash index. Released tasks go on a free list and are reused by the
+ * next task created.
+ */
+#define TASK_SLAB_SIZE 1024
+
+void task_table_init(void);
+void task_table_free(void);
+
+Task_t *task_table_create(int);
+Task_t *task_table_lookup(int);
+void task_table_release(Task_t *);
+int task_table_count(void);
+
+#endif
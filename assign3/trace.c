@@ -0,0 +1,171 @@
+/*
+ * trace.c
+ *
+ * Trace-event format: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#define PID_CPUS    0
+#define PID_QUEUES  1
+
+
+/*
+ * Start the next event of the traceEvents array.
+ */
+static void begin_event(Trace_t *trace) {
+    fputs(trace->first_event ? "\n" : ",\n", trace->fp);
+    trace->first_event = false;
+}
+
+
+static void name_track(Trace_t *trace, int pid, int tid, const char *kind, const char *name) {
+    begin_event(trace);
+    fprintf(trace->fp, "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+        kind, pid, tid, name);
+}
+
+
+/*
+ * The "Queues" track of the CPU's queue; queue 0 holds its real-time
+ * tasks.
+ */
+static int queue_tid(Trace_t *trace, int cpu, int queue) {
+    return cpu * (trace->num_levels + 1) + queue;
+}
+
+
+/*
+ * Write out the CPU's open slice, if it has one.
+ */
+static void end_slice(Trace_t *trace, int cpu) {
+    Trace_slice_t *slice = &trace->slices[cpu];
+    int tid = queue_tid(trace, cpu, slice->queue);
+
+    if (slice->task_id < 0) {
+        return;
+    }
+
+    begin_event(trace);
+    fprintf(trace->fp, "{\"name\":\"id=%04d\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%d,\"dur\":%d,\"args\":{\"queue\":%d}}",
+        slice->task_id, PID_CPUS, cpu, slice->start, slice->end - slice->start, slice->queue);
+    begin_event(trace);
+    fprintf(trace->fp, "{\"name\":\"id=%04d\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%d,\"dur\":%d}",
+        slice->task_id, PID_QUEUES, tid, slice->start, slice->end - slice->start);
+
+    trace->queue_used[tid] = true;
+    slice->task_id = -1;
+}
+
+
+/*
+ * Creates the trace file, exiting if it cannot be written.
+ */
+void trace_open(Trace_t *trace, const char *path, int num_cpus, int num_levels) {
+    trace->fp = fopen(path, "w");
+    if (trace->fp == NULL) {
+        fprintf(stderr, "Cannot write trace file \"%s\".\n", path);
+        exit(1);
+    }
+    setvbuf(trace->fp, NULL, _IOFBF, 1 << 20);
+
+    trace->num_cpus = num_cpus;
+    trace->num_levels = num_levels;
+    trace->slices = emalloc(num_cpus * sizeof(Trace_slice_t));
+    for (int c = 0; c < num_cpus; c++) {
+        trace->slices[c].task_id = -1;
+    }
+    trace->queue_used = emalloc(num_cpus * (num_levels + 1) * sizeof(bool));
+    memset(trace->queue_used, 0, num_cpus * (num_levels + 1) * sizeof(bool));
+    trace->first_event = true;
+
+    fputs("{\"traceEvents\":[", trace->fp);
+}
+
+
+/*
+ * Ends the open slices, names the tracks used and closes the file.
+ */
+void trace_close(Trace_t *trace) {
+    char name[32];
+
+    for (int c = 0; c < trace->num_cpus; c++) {
+        end_slice(trace, c);
+    }
+
+    name_track(trace, PID_CPUS, 0, "process_name", "CPUs");
+    name_track(trace, PID_QUEUES, 0, "process_name", "Queues");
+    for (int c = 0; c < trace->num_cpus; c++) {
+        sprintf(name, "cpu %d", c);
+        name_track(trace, PID_CPUS, c, "thread_name", name);
+        for (int level = 0; level <= trace->num_levels; level++) {
+            int tid = queue_tid(trace, c, level);
+
+            if (!trace->queue_used[tid]) {
+                continue;
+            }
+            if (level == 0) {
+                sprintf(name, trace->num_cpus == 1 ? "real-time" : "cpu %d real-time", c);
+            } else if (trace->num_cpus == 1) {
+                sprintf(name, "queue %d", level);
+            } else {
+                sprintf(name, "cpu %d queue %d", c, level);
+            }
+            name_track(trace, PID_QUEUES, tid, "thread_name", name);
+        }
+    }
+
+    fputs("\n]}\n", trace->fp);
+    if (fclose(trace->fp) != 0) {
+        perror("trace");
+        exit(1);
+    }
+    free(trace->slices);
+    free(trace->queue_used);
+}
+
+
+void trace_new(Trace_t *trace, int tick, int task_id) {
+    begin_event(trace);
+    fprintf(trace->fp, "{\"name\":\"NEW id=%04d\",\"ph\":\"i\",\"s\":\"p\",\"pid\":%d,\"tid\":0,\"ts\":%d}",
+        task_id, PID_CPUS, tick);
+}
+
+
+/*
+ * The CPU runs the task (or idles, if NULL) for `span` ticks from 
+ * `tick`.
+ */
+void trace_run(Trace_t *trace, int cpu, int tick, int span, Task_t *task) {
+    Trace_slice_t *slice = &trace->slices[cpu];
+
+    if (task != NULL && slice->task_id == task->id && 
+        slice->queue == task->current_queue && slice->end == tick) {
+        slice->end += span;
+        return;
+    }
+
+    end_slice(trace, cpu);
+    if (task != NULL) {
+        slice->task_id = task->id;
+        slice->queue = task->current_queue;
+        slice->start = tick;
+        slice->end = tick + span;
+    }
+}
+
+
+void trace_boost(Trace_t *trace, int tick, int cpu) {
+    begin_event(trace);
+    fprintf(trace->fp, "{\"name\":\"BOOST\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%d}",
+        PID_CPUS, cpu, tick);
+}
+
+
+void trace_exit(Trace_t *trace, int tick, int task_id, int wait, int turnaround) {
+    begin_event(trace);
+    fprintf(trace->fp, "{\"name\":\"EXIT id=%04d\",\"ph\":\"i\",\"s\":\"p\",\"pid\":%d,\"tid\":0,\"ts\":%d,\"args\":{\"wt\":%d,\"tat\":%d}}",
+        task_id, PID_CPUS, tick, wait, turnaround);
+}
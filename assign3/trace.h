@@ -0,0 +1,46 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "queue.h"
+
+/*
+ * A timeline of the simulation in the Chrome trace-event JSON format,
+ * which chrome://tracing and ui.perfetto.dev open. One tick is shown as
+ * one microsecond. Process "CPUs" has a track per CPU, and process
+ * "Queues" one per CPU and queue level, plus one per CPU for real-time
+ * tasks (queue 0); each run of a task is a slice on its CPU's track 
+ * and on the track of the queue it runs from. NEW and EXIT are instant
+ * events on the "CPUs" process, BOOST on the boosting CPU's track.
+ *
+ * Consecutive ticks of the same task on a CPU from the same queue make
+ * a single slice, so a trace grows with the number of scheduling 
+ * decisions rather than of ticks.
+ */
+typedef struct Trace_slice Trace_slice_t;
+struct Trace_slice {
+    int         task_id;        // -1 if no slice is open
+    int         queue;
+    int         start;
+    int         end;            // Tick after the last tick of the slice
+};
+
+typedef struct Trace Trace_t;
+struct Trace {
+    FILE        *fp;
+    int         num_cpus;
+    int         num_levels;
+    Trace_slice_t *slices;      // Open slice of each CPU
+    bool        *queue_used;    // [cpu * (num_levels + 1) + queue]
+    bool        first_event;
+};
+
+void trace_open(Trace_t *, const char *path, int num_cpus, int num_levels);
+void trace_close(Trace_t *);
+void trace_new(Trace_t *, int tick, int task_id);
+void trace_run(Trace_t *, int cpu, int tick, int span, Task_t *task);
+void trace_boost(Trace_t *, int tick, int cpu);
+void trace_exit(Trace_t *, int tick, int task_id, int wait, int turnaround);
+
+#endif
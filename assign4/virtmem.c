@@ -35,6 +35,7 @@ int setup(void);
 int teardown(void);
 int output_report(void);
 long resolve_address(long, int);
+long tiered_resolve_address(long, int);
 void error_resolve_address(long, int);
 
 
@@ -60,6 +61,8 @@ struct page_table_entry {
     int free;
     int last_access_time; // counter to keep track of last acces time for a page
     int use_bit; // recently used indicator bit for clock algorithm
+    int hint; // armed by the scanner so the next access takes a hinting fault
+    int heat; // hinting faults taken recently, used to pick pages to promote
 };
 
 
@@ -83,6 +86,51 @@ int fifo_rear = -1;
 // Keep track of clock hand position for clock algorithm
 int clock_hand = 0;
 
+
+/*
+ * Two-tier memory (enabled by --fastframes). Frames [0, fastframes)
+ * make up the fast tier and the --numframes frames after them make up
+ * the slow tier. New pages are always placed in the fast tier: when it
+ * is full, its coldest page (by the replacement scheme) is first
+ * demoted into the slow tier, and only the slow tier evicts pages to
+ * swap. --replace=optimal is not supported in this mode.
+ *
+ * Promotion is driven by sampled hinting faults, much like NUMA
+ * balancing: every scan_period references the scanner arms the hint
+ * bit on the next scan_pages slow-tier frames, and the next access to
+ * an armed page counts as a hinting fault. A page still armed when the
+ * scanner comes round again was not touched and has its heat halved.
+ * A page reaching promote_threshold faults is promoted; when the fast
+ * tier is full the promotion exchanges it with a victim that is
+ * demoted into the frame the promoted page vacated.
+ */
+#define TIER_FAST 0
+#define TIER_SLOW 1
+
+struct tier {
+    char *name;
+    int first_frame; // index of the tier's first frame in page_table
+    int num_frames;
+    int cost;        // cost charged for each access served by the tier
+    int hand;        // FIFO pointer / clock hand when choosing victims
+    long accesses;
+};
+
+int tiered = FALSE;
+struct tier tiers[2] = {
+    { "Fast", 0, 0, 1, 0, 0 },
+    { "Slow", 0, 0, 4, 0, 0 }
+};
+int promote_threshold = 2;
+int scan_period = 1000;
+int scan_pages = 64;
+int scan_cursor = 0;
+
+int hint_faults = 0;
+int promotions  = 0;
+int demotions   = 0;
+long access_cost = 0;
+
 /*
  * Function to convert a logical address into its corresponding 
  * physical address. The value returned by this function is the
@@ -243,6 +291,210 @@ long resolve_address(long logical, int memwrite)
 }
 
 
+/*
+ * Returns the tier to which the given frame belongs.
+ */
+int tier_of(int frame)
+{
+    return frame < tiers[TIER_SLOW].first_frame ? TIER_FAST : TIER_SLOW;
+}
+
+
+/*
+ * Returns a free frame within the tier, or -1 if the tier is full.
+ */
+int tier_free_frame(struct tier *t)
+{
+    int i;
+
+    for (i = t->first_frame; i < t->first_frame + t->num_frames; i++) {
+        if (page_table[i].free) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/*
+ * Chooses an occupied frame within a (full) tier to give up its page,
+ * using the replacement scheme selected on the command line.
+ */
+int tier_victim(struct tier *t)
+{
+    int i, frame;
+    int victim = t->first_frame;
+
+    if (page_replacement_scheme == REPLACE_LRU) {
+        for (i = t->first_frame; i < t->first_frame + t->num_frames; i++) {
+            if (page_table[i].last_access_time <
+                page_table[victim].last_access_time)
+            {
+                victim = i;
+            }
+        }
+        return victim;
+    }
+
+    for (;;) {
+        frame = t->first_frame + t->hand;
+        t->hand = (t->hand + 1) % t->num_frames;
+
+        if (page_replacement_scheme != REPLACE_CLOCK ||
+            !page_table[frame].use_bit)
+        {
+            return frame;
+        }
+        page_table[frame].use_bit = 0; // second chance
+    }
+}
+
+
+/*
+ * Arms the hint bit on the next batch of slow-tier frames, decaying
+ * the heat of pages that were not touched since they were last armed.
+ */
+void scan_hints()
+{
+    struct tier *slow = &tiers[TIER_SLOW];
+    int i, frame;
+
+    for (i = 0; i < scan_pages && i < slow->num_frames; i++) {
+        frame = slow->first_frame + scan_cursor;
+        scan_cursor = (scan_cursor + 1) % slow->num_frames;
+
+        if (!page_table[frame].free) {
+            if (page_table[frame].hint) {
+                page_table[frame].heat >>= 1;
+            }
+            page_table[frame].hint = TRUE;
+        }
+    }
+}
+
+
+/*
+ * Moves the page in a fast-tier frame into the slow tier, evicting a
+ * slow-tier page to swap if that tier is full, and returns the frame
+ * it vacated.
+ */
+int demote(int frame)
+{
+    int target = tier_free_frame(&tiers[TIER_SLOW]);
+
+    if (target == -1) {
+        target = tier_victim(&tiers[TIER_SLOW]);
+        if (page_table[target].dirty) {
+            swap_outs++;
+        }
+    }
+    page_table[target] = page_table[frame];
+    page_table[target].hint = FALSE;
+    page_table[target].heat = 0;
+    page_table[frame].free = TRUE;
+    demotions++;
+
+    return frame;
+}
+
+
+/*
+ * Moves the page in a slow-tier frame into the fast tier and returns
+ * its new frame. If the fast tier is full, its victim is demoted into
+ * the slow-tier frame being vacated.
+ */
+int promote(int frame)
+{
+    struct page_table_entry tmp;
+    int target;
+
+    page_table[frame].hint = FALSE;
+    page_table[frame].heat = 0;
+
+    target = tier_free_frame(&tiers[TIER_FAST]);
+    if (target != -1) {
+        page_table[target] = page_table[frame];
+        page_table[frame].free = TRUE;
+    } else {
+        target = tier_victim(&tiers[TIER_FAST]);
+        tmp = page_table[target];
+        page_table[target] = page_table[frame];
+        page_table[frame] = tmp;
+        demotions++;
+    }
+    promotions++;
+
+    return target;
+}
+
+
+/*
+ * Tiered counterpart of resolve_address(): faults pages into the fast
+ * tier when possible, charges each access the cost of the tier that
+ * serves it, and promotes pages that keep taking hinting faults.
+ */
+long tiered_resolve_address(long logical, int memwrite)
+{
+    int i;
+    long page, frame;
+    long offset;
+    long mask = 0;
+    int total_frames = tiers[TIER_FAST].num_frames + tiers[TIER_SLOW].num_frames;
+
+    page = (logical >> size_of_frame);
+    for (i=0; i < size_of_frame; i++) {
+        mask = mask << 1;
+        mask |= 1;
+    }
+    offset = logical & mask;
+
+    if (mem_refs > 0 && mem_refs % scan_period == 0) {
+        scan_hints();
+    }
+
+    frame = -1;
+    for (i = 0; i < total_frames; i++) {
+        if (!page_table[i].free && page_table[i].page_num == page) {
+            frame = i;
+            break;
+        }
+    }
+
+    if (frame == -1) {
+        page_faults++;
+
+        frame = tier_free_frame(&tiers[TIER_FAST]);
+        if (frame == -1) {
+            frame = demote(tier_victim(&tiers[TIER_FAST]));
+        }
+
+        page_table[frame].page_num = page;
+        page_table[frame].free = FALSE;
+        page_table[frame].dirty = FALSE;
+        page_table[frame].hint = FALSE;
+        page_table[frame].heat = 0;
+        swap_ins++;
+    } else if (page_table[frame].hint) {
+        hint_faults++;
+        page_table[frame].hint = FALSE;
+        page_table[frame].heat++;
+
+        if (page_table[frame].heat >= promote_threshold) {
+            frame = promote(frame);
+        }
+    }
+
+    page_table[frame].dirty |= memwrite;
+    page_table[frame].use_bit = 1;
+    page_table[frame].last_access_time = mem_refs;
+
+    tiers[tier_of(frame)].accesses++;
+    access_cost += tiers[tier_of(frame)].cost;
+
+    return (frame << size_of_frame) | offset;
+}
+
+
 
 /*
  * Super-simple progress bar.
@@ -276,6 +528,12 @@ int setup()
 {
     int i;
 
+    if (tiered) {
+        tiers[TIER_SLOW].first_frame = tiers[TIER_FAST].num_frames;
+        tiers[TIER_SLOW].num_frames = size_of_memory;
+        size_of_memory += tiers[TIER_FAST].num_frames;
+    }
+
     page_table = (struct page_table_entry *)malloc(
         sizeof(struct page_table_entry) * size_of_memory
     );
@@ -288,6 +546,8 @@ int setup()
 
     for (i=0; i<size_of_memory; i++) {
         page_table[i].free = TRUE;
+        page_table[i].hint = FALSE;
+        page_table[i].heat = 0;
     }
 
     return -1;
@@ -314,12 +574,27 @@ void error_resolve_address(long a, int l)
 
 int output_report()
 {
+    int i;
+
     printf("\n");
     printf("Memory references: %d\n", mem_refs);
     printf("Page faults: %d\n", page_faults);
     printf("Swap ins: %d\n", swap_ins);
     printf("Swap outs: %d\n", swap_outs);
 
+    if (tiered) {
+        for (i = TIER_FAST; i <= TIER_SLOW; i++) {
+            printf("%s-tier accesses: %ld\n", tiers[i].name, tiers[i].accesses);
+        }
+        printf("Hinting faults: %d\n", hint_faults);
+        printf("Promotions: %d\n", promotions);
+        printf("Demotions: %d\n", demotions);
+        printf("Migration traffic: %ld bytes\n",
+            (long)(promotions + demotions) << size_of_frame);
+        printf("Access cost: %ld (%.2f per reference)\n", access_cost,
+            mem_refs > 0 ? (double)access_cost / mem_refs : 0.0);
+    }
+
     return -1;
 }
 
@@ -373,6 +648,25 @@ int main(int argc, char **argv)
             size_of_memory = atoi(s);
         } else if (strcmp(argv[i], "--progress") == 0) {
             show_progress = TRUE;
+        } else if (strncmp(argv[i], "--fastframes=", 13) == 0) {
+            s = strstr(argv[i], "=") + 1;
+            tiers[TIER_FAST].num_frames = atoi(s);
+            tiered = TRUE;
+        } else if (strncmp(argv[i], "--fastcost=", 11) == 0) {
+            s = strstr(argv[i], "=") + 1;
+            tiers[TIER_FAST].cost = atoi(s);
+        } else if (strncmp(argv[i], "--slowcost=", 11) == 0) {
+            s = strstr(argv[i], "=") + 1;
+            tiers[TIER_SLOW].cost = atoi(s);
+        } else if (strncmp(argv[i], "--promote=", 10) == 0) {
+            s = strstr(argv[i], "=") + 1;
+            promote_threshold = atoi(s);
+        } else if (strncmp(argv[i], "--scanperiod=", 13) == 0) {
+            s = strstr(argv[i], "=") + 1;
+            scan_period = atoi(s);
+        } else if (strncmp(argv[i], "--scanpages=", 12) == 0) {
+            s = strstr(argv[i], "=") + 1;
+            scan_pages = atoi(s);
         }
     }
 
@@ -384,15 +678,28 @@ int main(int argc, char **argv)
         infile = fopen(infile_name, "r"); 
     }
 
+    if (tiered && page_replacement_scheme == REPLACE_OPTIMAL) {
+        fprintf(stderr, "%s: --replace=optimal is not supported with --fastframes\n",
+            argv[0]);
+        exit(1);
+    }
+
     if (page_replacement_scheme == REPLACE_NONE ||
         size_of_frame <= 0 ||
         size_of_memory <= 0 ||
+        (tiered && tiers[TIER_FAST].num_frames <= 0) ||
+        promote_threshold <= 0 ||
+        scan_period <= 0 ||
         infile == NULL)
     {
         fprintf(stderr, 
             "usage: %s --framesize=<m> --numframes=<n>", argv[0]);
         fprintf(stderr, 
             " --replace={fifo|lru|optimal} [--file=<filename>]\n");
+        fprintf(stderr,
+            "       [--fastframes=<n> [--fastcost=<c>] [--slowcost=<c>]"
+            " [--promote=<faults>]\n"
+            "        [--scanperiod=<refs>] [--scanpages=<n>]]\n");
         exit(1);
     }
 
@@ -409,7 +716,9 @@ int main(int argc, char **argv)
                 is_write = FALSE;
             }
 
-            if (resolve_address(addr, is_write) == -1) {
+            if (tiered) {
+                tiered_resolve_address(addr, is_write);
+            } else if (resolve_address(addr, is_write) == -1) {
                 error_resolve_address(addr, line_num);
             }
             mem_refs++;